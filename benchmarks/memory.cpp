@@ -0,0 +1,165 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+// Every allocation is prefixed with its size so that the number of live
+// heap bytes can be tracked exactly, including allocations made by xlnt.
+std::atomic<std::size_t> live_bytes(0);
+const std::size_t header_size = alignof(std::max_align_t);
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    auto block = static_cast<char *>(std::malloc(size + header_size));
+
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<std::size_t *>(block) = size;
+    live_bytes += size;
+
+    return block + header_size;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+
+    auto block = static_cast<char *>(pointer) - header_size;
+    live_bytes -= *reinterpret_cast<std::size_t *>(block);
+
+    std::free(block);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+namespace {
+
+// Fills a fresh worksheet using fill and reports the heap growth per cell.
+void measure(const std::string &name, std::function<void(xlnt::worksheet)> fill, std::size_t cells)
+{
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+
+    const auto before = live_bytes.load();
+    fill(ws);
+    const auto after = live_bytes.load();
+
+    std::cout << name << ": " << static_cast<double>(after - before) / static_cast<double>(cells)
+              << " bytes per cell" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    const auto rows = 10000;
+    const auto columns = 20;
+    const auto cells = static_cast<std::size_t>(rows * columns);
+
+    measure("numbers", [&](xlnt::worksheet ws) {
+        for (auto row = 1; row <= rows; ++row)
+        {
+            for (auto column = 1; column <= columns; ++column)
+            {
+                ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                    static_cast<xlnt::row_t>(row))).value(row * column);
+            }
+        }
+    }, cells);
+
+    measure("shared strings", [&](xlnt::worksheet ws) {
+        for (auto row = 1; row <= rows; ++row)
+        {
+            for (auto column = 1; column <= columns; ++column)
+            {
+                ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                    static_cast<xlnt::row_t>(row))).value(std::to_string(column));
+            }
+        }
+    }, cells);
+
+    measure("distinct shared strings", [&](xlnt::worksheet ws) {
+        for (auto row = 1; row <= rows; ++row)
+        {
+            for (auto column = 1; column <= columns; ++column)
+            {
+                ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                    static_cast<xlnt::row_t>(row))).value("string " + std::to_string(row * columns + column));
+            }
+        }
+    }, cells);
+
+    measure("numbers with every tenth a formula", [&](xlnt::worksheet ws) {
+        for (auto row = 1; row <= rows; ++row)
+        {
+            for (auto column = 1; column <= columns; ++column)
+            {
+                auto cell = ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                    static_cast<xlnt::row_t>(row)));
+                cell.value(row * column);
+
+                if (column % 10 == 0)
+                {
+                    cell.formula("=A1*2");
+                }
+            }
+        }
+    }, cells);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double nanoseconds_per_value(clock_type::time_point start, std::size_t count)
+{
+    const auto elapsed = std::chrono::duration<double, std::nano>(clock_type::now() - start);
+    return elapsed.count() / static_cast<double>(count);
+}
+
+// Formats values with format_string one at a time and in bulk and reports the cost per value.
+void measure(const std::string &format_string, const std::vector<long double> &values)
+{
+    const xlnt::number_format format(format_string);
+    std::size_t checksum = 0;
+
+    auto start = clock_type::now();
+
+    for (auto value : values)
+    {
+        checksum += format.format(value, xlnt::calendar::windows_1900).size();
+    }
+
+    const auto single = nanoseconds_per_value(start, values.size());
+
+    std::string buffer;
+    std::vector<std::size_t> offsets;
+
+    start = clock_type::now();
+    format.format(values.data(), values.size(), xlnt::calendar::windows_1900, buffer, offsets);
+    const auto bulk = nanoseconds_per_value(start, values.size());
+
+    checksum -= buffer.size();
+
+    std::cout << std::left << std::setw(28) << format_string << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1) << single << " ns"
+              << std::setw(10) << bulk << " ns"
+              << (checksum == 0 ? "" : "  (results differ)") << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    const std::size_t count = 200000;
+
+    std::vector<long double> values;
+    values.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // a spread of magnitudes, signs and fractions, all valid as dates
+        values.push_back(static_cast<long double>(i % 50000) * 1.37L + static_cast<long double>(i % 7) / 8.L);
+    }
+
+    std::cout << std::left << std::setw(28) << "format" << std::right
+              << std::setw(13) << "per value" << std::setw(13) << "bulk" << std::endl;
+
+    // patterns exercised by number_format_test_suite
+    for (const auto &format_string : {"General", "0", "0.00", "#,##0", "#,##0.00", "0%", "0.00%", "0.00E+00",
+             "# ?/?", "# ?" "?/??", "[Red]0.0;(0.0)", "#,##0.00_);[Red](#,##0.00)", "yyyy-mm-dd",
+             "mm-dd-yy", "d-mmm-yy", "h:mm:ss AM/PM", "[h]:mm:ss", "mm:ss.0"})
+    {
+        measure(format_string, values);
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <helpers/path_helper.hpp>
+#include <helpers/timing.hpp>
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+using xlnt::benchmarks::current_time;
+
+// Load a workbook whose second sheet is 26MB of sheetData XML and report how
+// quickly the worksheet XML was read.
+void reader(const xlnt::path &filename)
+{
+    const auto sheet_xml_bytes = 26589517.0;
+    auto best = std::size_t(0);
+
+    for (int run = 0; run < 3; ++run)
+    {
+        auto start = current_time();
+        xlnt::workbook wb;
+        wb.load(filename);
+        auto elapsed = current_time() - start;
+
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    std::cout << "took " << best / 1000.0 << "s to load " << filename.filename()
+              << " (" << sheet_xml_bytes / 1048576.0 / (best / 1000.0) << " MB/s of sheet XML)" << std::endl;
+}
+
+// Load a workbook of many equally sized worksheets with thread_count threads,
+// where 0 means one per hardware thread.
+void parallel_reader(const std::vector<std::uint8_t> &data, std::size_t thread_count)
+{
+    auto start = current_time();
+    xlnt::workbook wb;
+    wb.thread_count(thread_count);
+    wb.load(data);
+    auto elapsed = current_time() - start;
+
+    std::cout << "took " << elapsed / 1000.0 << "s to load " << wb.sheet_count() << " worksheets with "
+              << (thread_count == 0 ? "one thread per core" : std::to_string(thread_count) + " thread(s)") << std::endl;
+}
+
+std::vector<std::uint8_t> many_sheets(int sheets, int rows)
+{
+    xlnt::workbook wb;
+
+    for (int sheet = 0; sheet < sheets; ++sheet)
+    {
+        auto ws = sheet == 0 ? wb.active_sheet() : wb.create_sheet();
+
+        for (int row = 1; row <= rows; ++row)
+        {
+            for (int column = 1; column <= 10; ++column)
+            {
+                ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                    static_cast<xlnt::row_t>(row))).value(row * 0.5 + column);
+            }
+        }
+    }
+
+    std::vector<std::uint8_t> data;
+    wb.save(data);
+
+    return data;
+}
+
+} // namespace
+
+int main()
+{
+    reader(path_helper::benchmark_file("large.xlsx"));
+
+    const auto data = many_sheets(20, 10000);
+    parallel_reader(data, 1);
+    parallel_reader(data, 0);
+
+    return 0;
+}
@@ -164,6 +164,39 @@ void to_profile(xlnt::workbook &wb, const std::string &f, int n)
     std::cout << "took " << elapsed / 1000.0 << "s for " << n << " styles" << std::endl;
 }
 
+// Styles a table of rows x 20 cells with a bold header and banded fills through ranges.
+void range_styling(int rows)
+{
+    using xlnt::benchmarks::current_time;
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+
+    for (int row = 1; row <= rows; ++row)
+    {
+        for (int column = 1; column <= 20; ++column)
+        {
+            ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                static_cast<xlnt::row_t>(row))).value(row * column);
+        }
+    }
+
+    auto start = current_time();
+
+    ws.range("A1:T1").font(xlnt::font().bold(true));
+    ws.range(xlnt::range_reference(1, 2, 20, static_cast<xlnt::row_t>(rows))).font(xlnt::font().name("Arial"));
+
+    for (int row = 2; row <= rows; row += 2)
+    {
+        ws.range(xlnt::range_reference(1, static_cast<xlnt::row_t>(row), 20, static_cast<xlnt::row_t>(row)))
+            .fill(xlnt::fill::solid(xlnt::rgb_color(220, 230, 241)));
+    }
+
+    auto elapsed = current_time() - start;
+
+    std::cout << "took " << elapsed / 1000.0 << "s to style " << rows * 20 << " cells by range" << std::endl;
+}
+
 } // namespace
 
 int main()
@@ -173,5 +206,7 @@ int main()
     std::string f = "temp.xlsx";
     to_profile(wb, f, n);
 
+    range_styling(5000);
+
     return 0;
 }
@@ -58,6 +58,83 @@ void writer(int cols, int rows)
     wb.save(filename);
 }
 
+// Create a worksheet of non-integral numbers, which unlike integers can't be
+// written with a plain integer conversion.
+void fractional_writer(int cols, int rows)
+{
+    xlnt::workbook wb;
+    auto ws = wb.create_sheet();
+
+    for (int index = 0; index < rows; index++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            ws.cell(xlnt::cell_reference(i + 1, index + 1)).value((i + 1) * 1.1 + index / 3.0);
+        }
+    }
+
+    auto filename = "benchmark.xlsx";
+    wb.save(filename);
+}
+
+// Save a workbook of several equally sized worksheets, whose parts can be
+// rendered and compressed in parallel when thread_count allows it.
+void parallel_writer(int sheets, int rows, std::size_t thread_count)
+{
+    xlnt::workbook wb;
+    wb.thread_count(thread_count);
+
+    for (int sheet = 0; sheet < sheets; ++sheet)
+    {
+        auto ws = sheet == 0 ? wb.active_sheet() : wb.create_sheet();
+
+        for (int row = 1; row <= rows; ++row)
+        {
+            for (int column = 1; column <= 10; ++column)
+            {
+                ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                    static_cast<xlnt::row_t>(row))).value(row * 0.5 + column);
+            }
+        }
+    }
+
+    auto start = xlnt::benchmarks::current_time();
+    std::vector<std::uint8_t> data;
+    wb.save(data);
+    auto elapsed = xlnt::benchmarks::current_time() - start;
+
+    std::cout << "took " << elapsed / 1000.0 << "s to save " << sheets << " worksheets with "
+              << (thread_count == 0 ? "one thread per core" : std::to_string(thread_count) + " thread(s)") << std::endl;
+}
+
+// Save one large worksheet, deflated either as a single stream or in blocks
+// of block_size bytes on one thread per core.
+void block_writer(int rows, std::size_t block_size)
+{
+    xlnt::workbook wb;
+    wb.thread_count(0);
+    wb.compression_block_size(block_size);
+    auto ws = wb.active_sheet();
+
+    for (int row = 1; row <= rows; ++row)
+    {
+        for (int column = 1; column <= 10; ++column)
+        {
+            ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                static_cast<xlnt::row_t>(row))).value(row * 0.5 + column);
+        }
+    }
+
+    auto start = xlnt::benchmarks::current_time();
+    std::vector<std::uint8_t> data;
+    wb.save(data);
+    auto elapsed = xlnt::benchmarks::current_time() - start;
+
+    std::cout << "took " << elapsed / 1000.0 << "s to save " << data.size() << " bytes "
+              << (block_size == 0 ? std::string("as a single stream") : "in blocks of " + std::to_string(block_size))
+              << std::endl;
+}
+
 // Create a timeit call to a function and pass in keyword arguments.
 // The function is called twice, once using the standard workbook, then with the optimised one.
 // Time from the best of three is taken.
@@ -90,6 +167,11 @@ int main()
     timer(&writer, 8192, 100);
     timer(&writer, 10, 10000);
     timer(&writer, 4000, 1000);
+    timer(&fractional_writer, 100, 10000);
+    parallel_writer(20, 10000, 1);
+    parallel_writer(20, 10000, 0);
+    block_writer(200000, 0);
+    block_writer(200000, 1 << 20);
 
     return 0;
 }
@@ -47,6 +47,7 @@ class font;
 class format;
 class number_format;
 class protection;
+class string_view;
 class style;
 class workbook;
 class worksheet;
@@ -110,6 +111,14 @@ public:
     template <typename T>
     T value() const;
 
+    /// <summary>
+    /// Returns a view of the text of this cell directly from the workbook's shared
+    /// string table, without copying it. The view remains valid until the workbook
+    /// is cleared or destroyed. Throws invalid_data_type if this cell does not hold
+    /// a shared string.
+    /// </summary>
+    string_view text_view() const;
+
     /// <summary>
     /// Makes this cell have a value of type null.
     /// All other cell attributes are retained.
@@ -611,7 +620,9 @@ public:
     bool operator==(std::nullptr_t) const;
 
 private:
+    friend class range;
     friend class style;
+    friend class workbook;
     friend class worksheet;
     friend class detail::xlsx_consumer;
     friend class detail::xlsx_producer;
@@ -623,6 +634,13 @@ private:
     /// </summary>
     class format modifiable_format();
 
+    /// <summary>
+    /// Sets the format of this cell to new_format, the result of restyling its previous
+    /// format. Restyling already took a reference to new_format on this cell's behalf,
+    /// so this only moves the cell's reference from the previous format.
+    /// </summary>
+    void restyle(const class format new_format);
+
     /// <summary>
     /// Delete the default zero-argument constructor.
     /// </summary>
@@ -225,3 +225,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::border to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::border>
+{
+    /// <summary>
+    /// Returns a hash of b. Objects that compare equal have the same hash.
+    /// </summary>
+    size_t operator()(const xlnt::border &b) const;
+};
+
+} // namespace std
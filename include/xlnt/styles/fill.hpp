@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <functional>
 #include <unordered_map>
 
 #include <xlnt/xlnt_config.hpp>
@@ -367,3 +368,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::fill to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::fill>
+{
+    /// <summary>
+    /// Returns a hash of f. Objects that compare equal have the same hash.
+    /// </summary>
+    size_t operator()(const xlnt::fill &f) const;
+};
+
+} // namespace std
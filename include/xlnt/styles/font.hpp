@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 
 #include <xlnt/xlnt_config.hpp>
@@ -309,3 +310,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::font to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::font>
+{
+    /// <summary>
+    /// Returns a hash of f. Objects that compare equal have the same hash.
+    /// </summary>
+    size_t operator()(const xlnt::font &f) const;
+};
+
+} // namespace std
@@ -25,7 +25,9 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/utils/optional.hpp>
@@ -244,6 +246,15 @@ public:
     /// </summary>
     std::string format(long double number, calendar base_date) const;
 
+    /// <summary>
+    /// Formats the count numbers starting at numbers with the given base date, appending
+    /// each result to buffer in turn and the offset in buffer where it ends to offsets.
+    /// The format code is parsed once for all of them and buffer and offsets can be
+    /// reused between calls, so formatting many values doesn't allocate per value.
+    /// </summary>
+    void format(const long double *numbers, std::size_t count, calendar base_date,
+        std::string &buffer, std::vector<std::size_t> &offsets) const;
+
     /// <summary>
     /// Returns true if this format code returns a number formatted as a date.
     /// </summary>
@@ -272,3 +283,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::number_format to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::number_format>
+{
+    /// <summary>
+    /// Returns a hash of f. Objects that compare equal have the same hash.
+    /// </summary>
+    size_t operator()(const xlnt::number_format &f) const;
+};
+
+} // namespace std
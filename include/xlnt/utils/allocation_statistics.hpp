@@ -0,0 +1,72 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Describes the memory held by the arenas that store cells and their attributes.
+/// </summary>
+struct XLNT_API allocation_statistics
+{
+    /// <summary>
+    /// The number of bytes handed out by the arenas and not yet given back.
+    /// </summary>
+    std::size_t bytes_allocated = 0;
+
+    /// <summary>
+    /// The number of bytes the arenas have obtained from the system. This is
+    /// always at least bytes_allocated.
+    /// </summary>
+    std::size_t bytes_reserved = 0;
+
+    /// <summary>
+    /// The number of individual allocations served by the arenas.
+    /// </summary>
+    std::size_t allocations = 0;
+
+    /// <summary>
+    /// The number of chunks obtained from the system.
+    /// </summary>
+    std::size_t chunks = 0;
+
+    /// <summary>
+    /// Adds the statistics of other to these statistics.
+    /// </summary>
+    allocation_statistics &operator+=(const allocation_statistics &other)
+    {
+        bytes_allocated += other.bytes_allocated;
+        bytes_reserved += other.bytes_reserved;
+        allocations += other.allocations;
+        chunks += other.chunks;
+
+        return *this;
+    }
+};
+
+} // namespace xlnt
@@ -0,0 +1,134 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// A non-owning reference to a sequence of characters stored elsewhere, such as
+/// in a workbook's shared string table. It is only valid for as long as the storage
+/// it refers to.
+/// </summary>
+class XLNT_API string_view
+{
+public:
+    /// <summary>
+    /// Constructs an empty view.
+    /// </summary>
+    string_view() = default;
+
+    /// <summary>
+    /// Constructs a view of size characters starting at data.
+    /// </summary>
+    string_view(const char *data, std::size_t size)
+        : data_(data),
+          size_(size)
+    {
+    }
+
+    /// <summary>
+    /// Constructs a view of the characters of s.
+    /// </summary>
+    string_view(const std::string &s)
+        : data_(s.data()),
+          size_(s.size())
+    {
+    }
+
+    /// <summary>
+    /// Returns a pointer to the first character. The characters are not null-terminated.
+    /// </summary>
+    const char *data() const
+    {
+        return data_;
+    }
+
+    /// <summary>
+    /// Returns the number of characters in the view.
+    /// </summary>
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /// <summary>
+    /// Returns true if the view contains no characters.
+    /// </summary>
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    /// <summary>
+    /// Returns an iterator to the first character.
+    /// </summary>
+    const char *begin() const
+    {
+        return data_;
+    }
+
+    /// <summary>
+    /// Returns an iterator one past the last character.
+    /// </summary>
+    const char *end() const
+    {
+        return data_ + size_;
+    }
+
+    /// <summary>
+    /// Returns a copy of the characters as a std::string.
+    /// </summary>
+    std::string to_string() const
+    {
+        return std::string(data_, size_);
+    }
+
+    /// <summary>
+    /// Returns true if this view and other contain the same characters.
+    /// </summary>
+    bool operator==(const string_view &other) const
+    {
+        return size_ == other.size_ && (size_ == 0 || std::memcmp(data_, other.data_, size_) == 0);
+    }
+
+    /// <summary>
+    /// Returns true if this view and other contain different characters.
+    /// </summary>
+    bool operator!=(const string_view &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace xlnt
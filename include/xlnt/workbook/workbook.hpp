@@ -64,6 +64,7 @@ class range;
 class range_reference;
 class relationship;
 class streaming_workbook_reader;
+class string_view;
 class style;
 class style_serializer;
 class theme;
@@ -73,6 +74,7 @@ class worksheet;
 class worksheet_iterator;
 class zip_file;
 
+struct allocation_statistics;
 struct datetime;
 
 namespace detail {
@@ -282,10 +284,24 @@ public:
     const_iterator cend() const;
 
     /// <summary>
-    /// Applies the function "f" to every non-empty cell in every worksheet in this workbook.
+    /// Applies the function "f" to every non-empty cell in every worksheet in this workbook
+    /// in row-major order. f may create cells, but cells it creates aren't visited and
+    /// it must not remove any.
     /// </summary>
     void apply_to_cells(std::function<void(cell)> f);
 
+    /// <summary>
+    /// Applies the function "f" to every non-empty cell in every worksheet in this workbook,
+    /// splitting the rows of all worksheets among thread_count threads, or one per hardware
+    /// thread if thread_count is 0. f is called concurrently, so it may only read and
+    /// modify the cell it is given, and may only modify it by assigning a number or boolean
+    /// while its type isn't inline_string, formula_string or error. Anything else,
+    /// including clearing the cell or assigning a string, date or time, changes state
+    /// shared by the worksheet or the workbook and isn't safe. If f throws, the first
+    /// exception is rethrown once every thread has finished.
+    /// </summary>
+    void parallel_apply_to_cells(std::function<void(cell)> f, std::size_t thread_count = 0);
+
     /// <summary>
     /// Returns a temporary vector containing the titles of each sheet in the order
     /// of the sheets in the workbook.
@@ -297,6 +313,12 @@ public:
     /// </summary>
     std::size_t sheet_count() const;
 
+    /// <summary>
+    /// Returns the combined statistics of the arenas holding the cells of every
+    /// worksheet in this workbook.
+    /// </summary>
+    allocation_statistics arena_statistics() const;
+
     // Metadata Properties
 
     /// <summary>
@@ -424,6 +446,35 @@ public:
 
     // Serialization/Deserialization
 
+    /// <summary>
+    /// Returns the number of threads load and save may use to read or write worksheets at
+    /// the same time. 0 means one per hardware thread. The default is 1, which does
+    /// everything on the calling thread. The file saved is the same whatever the setting.
+    /// </summary>
+    std::size_t thread_count() const;
+
+    /// <summary>
+    /// Sets the number of threads load and save may use to read or write worksheets at the
+    /// same time, or 0 for one per hardware thread. The setting is kept when the workbook is cleared or loaded.
+    /// </summary>
+    void thread_count(std::size_t count);
+
+    /// <summary>
+    /// Returns the size in bytes of the blocks save splits each part into, so that a
+    /// large worksheet can be compressed on several threads as set by thread_count.
+    /// The default is 0, which compresses each part as a single stream.
+    /// </summary>
+    std::size_t compression_block_size() const;
+
+    /// <summary>
+    /// Sets the size in bytes of the blocks save splits each part into, or 0 to compress
+    /// each part as a single stream. Each block restarts compression with only the end
+    /// of the previous block as history, so smaller blocks compress slightly worse. The
+    /// file saved depends on the block size but not on thread_count. The setting is kept
+    /// when the workbook is cleared or loaded.
+    /// </summary>
+    void compression_block_size(std::size_t size);
+
     /// <summary>
     /// Serializes the workbook into an XLSX file and saves the bytes into
     /// byte vector data.
@@ -626,14 +677,16 @@ public:
     // Formats
 
     /// <summary>
-    /// Returns the cell format at the given index. The index is the position of
-    /// the format in xl/styles.xml.
+    /// Returns the cell format at the given index in constant time. The index is the
+    /// position of the format in xl/styles.xml. Throws invalid_parameter if there is
+    /// no format at that index.
     /// </summary>
     xlnt::format format(std::size_t format_index);
 
     /// <summary>
-    /// Returns the cell format at the given index. The index is the position of
-    /// the format in xl/styles.xml.
+    /// Returns the cell format at the given index in constant time. The index is the
+    /// position of the format in xl/styles.xml. Throws invalid_parameter if there is
+    /// no format at that index.
     /// </summary>
     const xlnt::format format(std::size_t format_index) const;
 
@@ -705,16 +758,29 @@ public:
     std::size_t add_shared_string(const rich_text &shared, bool allow_duplicates = false);
 
     /// <summary>
-    /// Returns a reference to the shared strings being used by cells
-    /// in this workbook.
+    /// Returns a copy of the shared strings being used by cells in this workbook.
+    /// The strings are stored compactly, so this builds every entry; prefer
+    /// shared_string and shared_string_count for large tables.
+    /// </summary>
+    std::vector<rich_text> shared_strings() const;
+
+    /// <summary>
+    /// Returns the shared string at index.
+    /// Throws invalid_parameter if there is no such string.
+    /// </summary>
+    rich_text shared_string(std::size_t index) const;
+
+    /// <summary>
+    /// Returns a view of the plain text of the shared string at index without
+    /// copying it. The view remains valid until the workbook is cleared or destroyed.
+    /// Throws invalid_parameter if there is no such string.
     /// </summary>
-    std::vector<rich_text> &shared_strings();
+    string_view shared_string_text(std::size_t index) const;
 
     /// <summary>
-    /// Returns a reference to the shared strings being used by cells
-    /// in this workbook.
+    /// Returns the number of strings in the shared string collection.
     /// </summary>
-    const std::vector<rich_text> &shared_strings() const;
+    std::size_t shared_string_count() const;
 
     // Thumbnail
 
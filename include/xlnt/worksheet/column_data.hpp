@@ -0,0 +1,68 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_type.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// The contents of a run of cells in one column, extracted in bulk by
+/// worksheet::read_column. Element i of each vector describes the cell in
+/// row first_row + i.
+/// </summary>
+struct XLNT_API column_data
+{
+    /// <summary>
+    /// The row of the first element.
+    /// </summary>
+    row_t first_row = 1;
+
+    /// <summary>
+    /// The type of each cell. Cells that don't exist have type empty.
+    /// </summary>
+    std::vector<cell_type> types;
+
+    /// <summary>
+    /// True for each cell that exists and has a value.
+    /// </summary>
+    std::vector<bool> valid;
+
+    /// <summary>
+    /// The value of each number or boolean cell and 0 for every other cell.
+    /// </summary>
+    std::vector<double> numbers;
+
+    /// <summary>
+    /// The plain text of each string or error cell and an empty string for every other cell.
+    /// </summary>
+    std::vector<std::string> strings;
+};
+
+} // namespace xlnt
@@ -46,6 +46,7 @@
 namespace xlnt {
 
 class const_range_iterator;
+class format;
 class range_iterator;
 
 /// <summary>
@@ -281,6 +282,13 @@ public:
     bool operator!=(const range &comparand) const;
 
 private:
+    /// <summary>
+    /// Sets the format of every cell in this range to the result of applying change to
+    /// its current format. change is called once per distinct format in the range rather
+    /// than once per cell, and the cells sharing a format are all pointed at its result.
+    /// </summary>
+    void restyle(std::function<class format(class format)> change);
+
     /// <summary>
     /// The worksheet this range is within
     /// </summary>
@@ -27,10 +27,13 @@
 #include <iterator>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/packaging/relationship.hpp>
 #include <xlnt/worksheet/page_margins.hpp>
@@ -60,6 +63,8 @@ class const_table_iterator;
 class table_iterator;
 class workbook;
 
+struct allocation_statistics;
+struct column_data;
 struct date;
 
 namespace detail {
@@ -206,6 +211,61 @@ public:
     /// </summary>
     const class cell cell(column_t column, row_t row) const;
 
+    /// <summary>
+    /// Sets count consecutive cells of row, starting at first_column, to the numbers
+    /// in values. This is much faster than setting each cell individually.
+    /// </summary>
+    void write_row(row_t row, const double *values, std::size_t count, column_t first_column = 1);
+
+    /// <summary>
+    /// Sets consecutive cells of row, starting at first_column, to the numbers in values.
+    /// </summary>
+    void write_row(row_t row, const std::vector<double> &values, column_t first_column = 1);
+
+    /// <summary>
+    /// Sets consecutive cells of row, starting at first_column, to the strings in values.
+    /// </summary>
+    void write_row(row_t row, const std::vector<std::string> &values, column_t first_column = 1);
+
+    /// <summary>
+    /// Sets consecutive cells of row, starting at first_column, to the elements of values.
+    /// Each element may be of any type accepted by cell::value.
+    /// </summary>
+    template <typename... Types>
+    void write_row(row_t row, const std::tuple<Types...> &values, column_t first_column = 1)
+    {
+        reserve_row(row, first_column, sizeof...(Types));
+        write_elements(row, first_column, values, std::index_sequence_for<Types...>());
+    }
+
+    /// <summary>
+    /// Sets the rows x columns block of cells whose top-left cell is top_left to the
+    /// numbers in values. values is in column-major order, i.e. the number for the cell
+    /// at zero-based offset (column, row) is values[column * rows + row].
+    /// </summary>
+    void write_block(const cell_reference &top_left, const double *values, std::size_t rows, std::size_t columns);
+
+    /// <summary>
+    /// Returns the values of the cells in column from first_row to last_row inclusive.
+    /// Cells that don't exist or don't hold a number or boolean are returned as NaN.
+    /// This is much faster than reading each cell individually. Throws invalid_parameter
+    /// if either row is outside of the sheet.
+    /// </summary>
+    std::vector<double> read_numbers(column_t column, row_t first_row, row_t last_row) const;
+
+    /// <summary>
+    /// Returns the plain text of the cells in column from first_row to last_row inclusive.
+    /// Cells that don't exist or don't hold a string or error are returned as empty strings.
+    /// Throws invalid_parameter if either row is outside of the sheet.
+    /// </summary>
+    std::vector<std::string> read_strings(column_t column, row_t first_row, row_t last_row) const;
+
+    /// <summary>
+    /// Returns the types, validity and values of the cells in column from first_row
+    /// to last_row inclusive. Throws invalid_parameter if either row is outside of the sheet.
+    /// </summary>
+    column_data read_column(column_t column, row_t first_row, row_t last_row) const;
+
     /// <summary>
     /// Returns the range defined by reference string. If reference string is the name of
     /// a previously-defined named range in the sheet, it will be returned.
@@ -256,11 +316,19 @@ public:
     /// </summary>
     const class range columns(bool skip_null = true) const;
 
-    //TODO: finish implementing cell_iterator wrapping before uncommenting
-    //class cell_vector cells(bool skip_null = true);
+    /// <summary>
+    /// Returns a vector of all cells in this sheet which will be iterated upon
+    /// in row-major order, continuing with the next row after the end of each row.
+    /// If skip_null is true (default), only cells that exist will be visited.
+    /// </summary>
+    class cell_vector cells(bool skip_null = true);
 
-    //TODO: finish implementing cell_iterator wrapping before uncommenting
-    //const class cell_vector cells(bool skip_null = true) const;
+    /// <summary>
+    /// Returns a vector of all cells in this sheet which will be iterated upon
+    /// in row-major order, continuing with the next row after the end of each row.
+    /// If skip_null is true (default), only cells that exist will be visited.
+    /// </summary>
+    const class cell_vector cells(bool skip_null = true) const;
 
     // properties
 
@@ -553,6 +621,12 @@ public:
     /// </summary>
     void reserve(std::size_t n);
 
+    /// <summary>
+    /// Returns statistics about the arena holding this worksheet's cells and
+    /// their formulas, hyperlinks, comments and text.
+    /// </summary>
+    allocation_statistics arena_statistics() const;
+
     /// <summary>
     /// Returns true if this sheet has a header/footer.
     /// </summary>
@@ -693,6 +767,8 @@ public:
 
 private:
     friend class cell;
+    friend class cell_iterator;
+    friend class const_cell_iterator;
     friend class const_range_iterator;
     friend class range_iterator;
     friend class const_table_iterator;
@@ -707,6 +783,23 @@ private:
     /// </summary>
     worksheet(detail::worksheet_impl *d);
 
+    /// <summary>
+    /// Prepares row to receive count cells starting at first_column.
+    /// </summary>
+    void reserve_row(row_t row, column_t first_column, std::size_t count);
+
+    /// <summary>
+    /// Sets the cells of row starting at first_column to the elements of values.
+    /// </summary>
+    template <typename Tuple, std::size_t... Indices>
+    void write_elements(row_t row, column_t first_column, const Tuple &values, std::index_sequence<Indices...>)
+    {
+        using expand = int[];
+        (void)expand{0, (cell(column_t(first_column.index + static_cast<column_t::index_t>(Indices)), row)
+                                .value(std::get<Indices>(values)),
+                            0)...};
+    }
+
     /// <summary>
     /// Creates a comments part in the manifest as a relationship target of this sheet.
     /// </summary>
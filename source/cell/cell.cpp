@@ -24,11 +24,13 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <sstream>
 
 #include <detail/implementations/cell_impl.hpp>
 #include <detail/implementations/format_impl.hpp>
 #include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/cell/comment.hpp>
@@ -46,6 +48,7 @@
 #include <xlnt/utils/date.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/string_view.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -144,6 +147,65 @@ std::pair<bool, xlnt::time> cast_time(const std::string &s)
     return {true, result};
 }
 
+/// <summary>
+/// Returns true if cells of the given type keep their text in the cell_text_
+/// side table of their worksheet rather than in the shared string table.
+/// </summary>
+bool has_own_text(xlnt::cell_type type)
+{
+    return type == xlnt::cell_type::inline_string
+        || type == xlnt::cell_type::formula_string
+        || type == xlnt::cell_type::error;
+}
+
+/// <summary>
+/// Sets the value of d to number, dropping any text it held before.
+/// </summary>
+void set_numeric(xlnt::detail::cell_impl *d, double number, xlnt::cell_type type = xlnt::cell_type::number)
+{
+    if (has_own_text(d->type_))
+    {
+        d->parent_->cell_text_.erase(d->key());
+    }
+
+    d->value_numeric_ = number;
+    d->type_ = type;
+}
+
+/// <summary>
+/// Copies the side table entry at from_key in from to to_key in to, or removes
+/// the entry at to_key if there is nothing to copy. target owns to.
+/// </summary>
+template <typename T>
+void copy_attribute(const xlnt::detail::side_table<T> &from, std::uint64_t from_key,
+    xlnt::detail::side_table<T> &to, std::uint64_t to_key, xlnt::detail::worksheet_impl &/*target*/)
+{
+    auto match = from.find(from_key);
+
+    if (match == from.end())
+    {
+        to.erase(to_key);
+        return;
+    }
+
+    auto copy = match->second;
+    to[to_key] = std::move(copy);
+}
+
+void copy_attribute(const xlnt::detail::side_table<xlnt::detail::arena_string> &from, std::uint64_t from_key,
+    xlnt::detail::side_table<xlnt::detail::arena_string> &to, std::uint64_t to_key, xlnt::detail::worksheet_impl &target)
+{
+    auto match = from.find(from_key);
+
+    if (match == from.end())
+    {
+        target.erase_string(to, to_key);
+        return;
+    }
+
+    target.store_string(to, to_key, match->second);
+}
+
 } // namespace
 
 namespace xlnt {
@@ -204,50 +266,42 @@ void cell::value(std::nullptr_t)
 
 void cell::value(bool boolean_value)
 {
-    d_->type_ = type::boolean;
-    d_->value_numeric_ = boolean_value ? 1.0L : 0.0L;
+    set_numeric(d_, boolean_value ? 1.0 : 0.0, type::boolean);
 }
 
 void cell::value(int int_value)
 {
-    d_->value_numeric_ = static_cast<long double>(int_value);
-    d_->type_ = type::number;
+    set_numeric(d_, static_cast<double>(int_value));
 }
 
 void cell::value(unsigned int int_value)
 {
-    d_->value_numeric_ = static_cast<long double>(int_value);
-    d_->type_ = type::number;
+    set_numeric(d_, static_cast<double>(int_value));
 }
 
 void cell::value(long long int int_value)
 {
-    d_->value_numeric_ = static_cast<long double>(int_value);
-    d_->type_ = type::number;
+    set_numeric(d_, static_cast<double>(int_value));
 }
 
 void cell::value(unsigned long long int int_value)
 {
-    d_->value_numeric_ = static_cast<long double>(int_value);
-    d_->type_ = type::number;
+    set_numeric(d_, static_cast<double>(int_value));
 }
 
 void cell::value(float float_value)
 {
-    d_->value_numeric_ = static_cast<long double>(float_value);
-    d_->type_ = type::number;
+    set_numeric(d_, static_cast<double>(float_value));
 }
 
 void cell::value(double float_value)
 {
-    d_->value_numeric_ = static_cast<long double>(float_value);
-    d_->type_ = type::number;
+    set_numeric(d_, float_value);
 }
 
 void cell::value(long double d)
 {
-    d_->value_numeric_ = d;
-    d_->type_ = type::number;
+    set_numeric(d_, static_cast<double>(d));
 }
 
 void cell::value(const std::string &s)
@@ -259,8 +313,7 @@ void cell::value(const rich_text &text)
 {
     check_string(text.plain_text());
 
-    d_->type_ = type::shared_string;
-    d_->value_numeric_ = static_cast<long double>(workbook().add_shared_string(text));
+    set_numeric(d_, static_cast<double>(workbook().add_shared_string(text)), type::shared_string);
 }
 
 void cell::value(const char *c)
@@ -270,39 +323,72 @@ void cell::value(const char *c)
 
 void cell::value(const cell c)
 {
+    const auto &source = *c.d_->parent_;
+    auto &target = *d_->parent_;
+
+    copy_attribute(source.cell_text_, c.d_->key(), target.cell_text_, d_->key(), target);
+    copy_attribute(source.hyperlinks_, c.d_->key(), target.hyperlinks_, d_->key(), target);
+    copy_attribute(source.formulae_, c.d_->key(), target.formulae_, d_->key(), target);
+    copy_attribute(source.comments_, c.d_->key(), target.comments_, d_->key(), target);
+    target.shared_formula_cells_.erase(d_->key());
+
+    if (c.d_->has_formula_ && source.formulae_.count(c.d_->key()) == 0)
+    {
+        // members of a shared formula group are copied as the formula they expand to
+        target.store_string(target.formulae_, d_->key(), c.formula());
+    }
+
     d_->type_ = c.d_->type_;
     d_->value_numeric_ = c.d_->value_numeric_;
-    d_->value_text_ = c.d_->value_text_;
-    d_->hyperlink_ = c.d_->hyperlink_;
-    d_->formula_ = c.d_->formula_;
-    d_->format_ = c.d_->format_;
+
+    if (d_->type_ == type::shared_string && source.parent_ != target.parent_)
+    {
+        // the index is only meaningful in the source's shared string table
+        const auto text = c.workbook().shared_string(static_cast<std::size_t>(c.d_->value_numeric_));
+        d_->value_numeric_ = static_cast<double>(workbook().add_shared_string(text));
+    }
+
+    d_->has_hyperlink_ = c.d_->has_hyperlink_;
+    d_->has_formula_ = c.d_->has_formula_;
+    d_->has_comment_ = c.d_->has_comment_;
+
+    // through format and clear_format so the stylesheet's reference counts stay right
+    if (c.has_format())
+    {
+        format(c.format());
+    }
+    else if (has_format())
+    {
+        clear_format();
+    }
+
+    if (d_->has_comment_)
+    {
+        worksheet().register_comments_in_manifest();
+    }
 }
 
 void cell::value(const date &d)
 {
-    d_->type_ = type::number;
-    d_->value_numeric_ = d.to_number(base_date());
+    set_numeric(d_, d.to_number(base_date()));
     number_format(number_format::date_yyyymmdd2());
 }
 
 void cell::value(const datetime &d)
 {
-    d_->type_ = type::number;
-    d_->value_numeric_ = d.to_number(base_date());
+    set_numeric(d_, d.to_number(base_date()));
     number_format(number_format::date_datetime());
 }
 
 void cell::value(const time &t)
 {
-    d_->type_ = type::number;
-    d_->value_numeric_ = t.to_number();
+    set_numeric(d_, t.to_number());
     number_format(number_format::date_time6());
 }
 
 void cell::value(const timedelta &t)
 {
-    d_->type_ = type::number;
-    d_->value_numeric_ = t.to_number();
+    set_numeric(d_, t.to_number());
     number_format(xlnt::number_format("[hh]:mm:ss"));
 }
 
@@ -348,23 +434,36 @@ bool cell::operator==(const cell &comparand) const
 
 cell &cell::operator=(const cell &rhs)
 {
+    if (rhs.has_format())
+    {
+        format(rhs.format());
+    }
+    else if (has_format())
+    {
+        clear_format();
+    }
+
     d_->column_ = rhs.d_->column_;
-    d_->format_ = rhs.d_->format_;
-    d_->formula_ = rhs.d_->formula_;
-    d_->hyperlink_ = rhs.d_->hyperlink_;
+    d_->has_formula_ = rhs.d_->has_formula_;
+    d_->has_hyperlink_ = rhs.d_->has_hyperlink_;
+    d_->has_comment_ = rhs.d_->has_comment_;
     d_->is_merged_ = rhs.d_->is_merged_;
     d_->parent_ = rhs.d_->parent_;
     d_->row_ = rhs.d_->row_;
     d_->type_ = rhs.d_->type_;
     d_->value_numeric_ = rhs.d_->value_numeric_;
-    d_->value_text_ = rhs.d_->value_text_;
 
     return *this;
 }
 
 std::string cell::hyperlink() const
 {
-    return d_->hyperlink_.get();
+    if (!d_->has_hyperlink_)
+    {
+        throw invalid_attribute();
+    }
+
+    return d_->parent_->hyperlinks_.at(d_->key()).str();
 }
 
 void cell::hyperlink(const std::string &hyperlink)
@@ -374,7 +473,8 @@ void cell::hyperlink(const std::string &hyperlink)
         throw invalid_parameter();
     }
 
-    d_->hyperlink_ = hyperlink;
+    d_->parent_->store_string(d_->parent_->hyperlinks_, d_->key(), hyperlink);
+    d_->has_hyperlink_ = true;
 }
 
 void cell::hyperlink(const std::string &url, const std::string &display)
@@ -395,35 +495,32 @@ void cell::formula(const std::string &formula)
         return clear_formula();
     }
 
-    if (formula[0] == '=')
-    {
-        d_->formula_ = formula.substr(1);
-    }
-    else
-    {
-        d_->formula_ = formula;
-    }
-
-    data_type(type::number);
-    
+    d_->parent_->set_formula(*d_, formula);
     worksheet().register_calc_chain_in_manifest();
 }
 
 bool cell::has_formula() const
 {
-    return d_->formula_.is_set();
+    return d_->has_formula_;
 }
 
 std::string cell::formula() const
 {
-    return d_->formula_.get();
+    if (!d_->has_formula_)
+    {
+        throw invalid_attribute();
+    }
+
+    return d_->parent_->formula(*d_);
 }
 
 void cell::clear_formula()
 {
     if (has_formula())
     {
-        d_->formula_.clear();
+        d_->parent_->erase_string(d_->parent_->formulae_, d_->key());
+        d_->parent_->shared_formula_cells_.erase(d_->key());
+        d_->has_formula_ = false;
         worksheet().garbage_collect_formulae();
     }
 }
@@ -435,7 +532,7 @@ void cell::error(const std::string &error)
         throw invalid_data_type();
     }
 
-    d_->value_text_.plain_text(error);
+    d_->parent_->cell_text_[d_->key()].plain_text(error);
     d_->type_ = type::error;
 }
 
@@ -525,16 +622,14 @@ protection cell::computed_protection() const
 
 void cell::clear_value()
 {
-    d_->value_numeric_ = 0;
-    d_->value_text_.clear();
-    d_->type_ = cell::type::empty;
+    set_numeric(d_, 0, cell::type::empty);
     clear_formula();
 }
 
 template <>
 XLNT_API bool cell::value() const
 {
-    return d_->value_numeric_ != 0.L;
+    return d_->value_numeric_ != 0.0;
 }
 
 template <>
@@ -570,13 +665,13 @@ XLNT_API float cell::value() const
 template <>
 XLNT_API double cell::value() const
 {
-    return static_cast<double>(d_->value_numeric_);
+    return d_->value_numeric_;
 }
 
 template <>
 XLNT_API long double cell::value() const
 {
-    return d_->value_numeric_;
+    return static_cast<long double>(d_->value_numeric_);
 }
 
 template <>
@@ -606,54 +701,79 @@ XLNT_API timedelta cell::value() const
 void cell::alignment(const class alignment &alignment_)
 {
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
-    format(new_format.alignment(alignment_, true));
+    restyle(new_format.alignment(alignment_, true));
 }
 
 void cell::border(const class border &border_)
 {
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
-    format(new_format.border(border_, true));
+    restyle(new_format.border(border_, true));
 }
 
 void cell::fill(const class fill &fill_)
 {
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
-    format(new_format.fill(fill_, true));
+    restyle(new_format.fill(fill_, true));
 }
 
 void cell::font(const class font &font_)
 {
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
-    format(new_format.font(font_, true));
+    restyle(new_format.font(font_, true));
 }
 
 void cell::number_format(const class number_format &number_format_)
 {
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
-    format(new_format.number_format(number_format_, true));
+    restyle(new_format.number_format(number_format_, true));
 }
 
 void cell::protection(const class protection &protection_)
 {
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
-    format(new_format.protection(protection_, true));
+    restyle(new_format.protection(protection_, true));
 }
 
 template <>
 XLNT_API std::string cell::value() const
 {
+    if (data_type() == cell::type::shared_string)
+    {
+        return text_view().to_string();
+    }
+
     return value<rich_text>().plain_text();
 }
 
+string_view cell::text_view() const
+{
+    if (data_type() != cell::type::shared_string)
+    {
+        throw invalid_data_type();
+    }
+
+    return workbook().shared_string_text(static_cast<std::size_t>(d_->value_numeric_));
+}
+
 template <>
 XLNT_API rich_text cell::value() const
 {
     if (data_type() == cell::type::shared_string)
     {
-        return workbook().shared_strings().at(static_cast<std::size_t>(d_->value_numeric_));
+        return workbook().shared_string(static_cast<std::size_t>(d_->value_numeric_));
     }
 
-    return d_->value_text_;
+    if (has_own_text(d_->type_))
+    {
+        auto match = d_->parent_->cell_text_.find(d_->key());
+
+        if (match != d_->parent_->cell_text_.end())
+        {
+            return match->second;
+        }
+    }
+
+    return rich_text();
 }
 
 bool cell::has_value() const
@@ -686,17 +806,19 @@ std::string cell::to_string() const
 
 bool cell::has_format() const
 {
-    return d_->format_.is_set();
+    return d_->format_ != nullptr;
 }
 
 void cell::format(const class format new_format)
 {
+    new_format.d_->parent->retain(*new_format.d_);
+
     if (has_format())
     {
-        format().d_->references -= format().d_->references > 0 ? 1 : 0;
+        // the old format may belong to another workbook's stylesheet
+        d_->format_->parent->release(*d_->format_);
     }
 
-    ++new_format.d_->references;
     d_->format_ = new_format.d_;
 }
 
@@ -735,8 +857,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
     if (percentage.first)
     {
-        d_->value_numeric_ = percentage.second;
-        d_->type_ = cell::type::number;
+        set_numeric(d_, static_cast<double>(percentage.second));
         number_format(xlnt::number_format::percentage());
     }
     else
@@ -745,9 +866,8 @@ void cell::value(const std::string &value_string, bool infer_type)
 
         if (time.first)
         {
-            d_->type_ = cell::type::number;
+            set_numeric(d_, time.second.to_number());
             number_format(number_format::date_time6());
-            d_->value_numeric_ = time.second.to_number();
         }
         else
         {
@@ -755,8 +875,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
             if (numeric.first)
             {
-                d_->value_numeric_ = numeric.second;
-                d_->type_ = cell::type::number;
+                set_numeric(d_, static_cast<double>(numeric.second));
             }
         }
     }
@@ -764,8 +883,9 @@ void cell::value(const std::string &value_string, bool infer_type)
 
 void cell::clear_format()
 {
-    format().d_->references -= format().d_->references > 0 ? 1 : 0;
-    d_->format_.clear();
+    const auto current = format().d_;
+    current->parent->release(*current);
+    d_->format_ = nullptr;
 }
 
 void cell::clear_style()
@@ -779,7 +899,7 @@ void cell::clear_style()
 void cell::style(const class style &new_style)
 {
     auto new_format = has_format() ? format() : workbook().create_format();
-    format(new_format.style(new_style));
+    restyle(new_format.style(new_style));
 }
 
 void cell::style(const std::string &style_name)
@@ -814,24 +934,30 @@ bool cell::has_style() const
     return has_format() && format().has_style();
 }
 
+void cell::restyle(const class format new_format)
+{
+    format(new_format);
+    new_format.d_->parent->release(*new_format.d_);
+}
+
 format cell::modifiable_format()
 {
-    if (!d_->format_.is_set())
+    if (d_->format_ == nullptr)
     {
         throw invalid_attribute();
     }
 
-    return xlnt::format(d_->format_.get());
+    return xlnt::format(d_->format_);
 }
 
 const format cell::format() const
 {
-    if (!d_->format_.is_set())
+    if (d_->format_ == nullptr)
     {
         throw invalid_attribute();
     }
 
-    return xlnt::format(d_->format_.get());
+    return xlnt::format(d_->format_);
 }
 
 alignment cell::alignment() const
@@ -866,19 +992,20 @@ protection cell::protection() const
 
 bool cell::has_hyperlink() const
 {
-    return d_->hyperlink_.is_set();
+    return d_->has_hyperlink_;
 }
 
 // comment
 
 bool cell::has_comment()
 {
-    return d_->comment_.is_set();
+    return d_->has_comment_;
 }
 
 void cell::clear_comment()
 {
-    d_->comment_.clear();
+    d_->parent_->comments_.erase(d_->key());
+    d_->has_comment_ = false;
 }
 
 class comment cell::comment()
@@ -888,7 +1015,7 @@ class comment cell::comment()
         throw xlnt::exception("cell has no comment");
     }
 
-    return d_->comment_.get();
+    return d_->parent_->comments_.at(d_->key());
 }
 
 void cell::comment(const std::string &text, const std::string &author)
@@ -904,15 +1031,17 @@ void cell::comment(const std::string &text, const class font &comment_font, cons
 
 void cell::comment(const class comment &new_comment)
 {
-    d_->comment_.set(new_comment);
+    auto &stored_comment = d_->parent_->comments_[d_->key()];
+    stored_comment = new_comment;
+    d_->has_comment_ = true;
 
     // offset comment 5 pixels down and 5 pixels right of the top right corner of the cell
     auto cell_position = anchor();
     cell_position.first += static_cast<int>(width()) + 5;
     cell_position.second += 5;
 
-    d_->comment_.get().position(cell_position.first, cell_position.second);
-    d_->comment_.get().size(200, 100);
+    stored_comment.position(cell_position.first, cell_position.second);
+    stored_comment.size(200, 100);
 
     worksheet().register_comments_in_manifest();
 }
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <array>
 #include <assert.h>
+#include <stdexcept>
 #include <stdlib.h>
 #include <stdio.h>
 
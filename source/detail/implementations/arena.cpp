@@ -0,0 +1,157 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include <detail/implementations/arena.hpp>
+
+namespace {
+
+const std::size_t min_chunk_size = 4096;
+const std::size_t max_chunk_size = 1 << 20;
+
+// blocks that can be reused are aligned to and padded to a multiple of this,
+// which also leaves room for the free list link
+const std::size_t granule = sizeof(void *);
+
+std::size_t padded_size(std::size_t size)
+{
+    return (std::max(size, granule) + granule - 1) / granule * granule;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+arena::arena()
+    : next_chunk_size_(min_chunk_size),
+      current_(nullptr),
+      remaining_(0)
+{
+}
+
+void arena::add_chunk(std::size_t minimum_size)
+{
+    const auto size = std::max(next_chunk_size_, minimum_size);
+    next_chunk_size_ = std::min(next_chunk_size_ * 2, max_chunk_size);
+
+    chunks_.emplace_back(new char[size]);
+    current_ = chunks_.back().get();
+    remaining_ = size;
+
+    statistics_.bytes_reserved += size;
+    ++statistics_.chunks;
+}
+
+void *arena::allocate(std::size_t size, std::size_t alignment)
+{
+    if (alignment <= granule)
+    {
+        size = padded_size(size);
+        alignment = granule;
+
+        auto match = free_blocks_.find(size);
+
+        if (match != free_blocks_.end() && match->second != nullptr)
+        {
+            auto block = match->second;
+            match->second = block->next;
+
+            statistics_.bytes_allocated += size;
+            ++statistics_.allocations;
+
+            return block;
+        }
+    }
+
+    auto padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+
+    if (current_ == nullptr || padding + size > remaining_)
+    {
+        // memory from new[] is suitably aligned for any fundamental type
+        add_chunk(size);
+        padding = 0;
+    }
+
+    auto result = current_ + padding;
+    current_ += padding + size;
+    remaining_ -= padding + size;
+
+    statistics_.bytes_allocated += size;
+    ++statistics_.allocations;
+
+    return result;
+}
+
+void arena::deallocate(void *memory, std::size_t size, std::size_t alignment)
+{
+    // over-aligned blocks are rare and aren't worth a separate free list
+    if (memory == nullptr || alignment > granule)
+    {
+        return;
+    }
+
+    size = padded_size(size);
+
+    auto &head = free_blocks_[size];
+    head = new (memory) free_block{head};
+
+    statistics_.bytes_allocated -= size;
+}
+
+arena_string arena::store(const std::string &s)
+{
+    return store(arena_string{s.data(), s.size()});
+}
+
+arena_string arena::store(const arena_string &s)
+{
+    if (s.size == 0)
+    {
+        return {"", 0};
+    }
+
+    auto data = static_cast<char *>(allocate(s.size, 1));
+    std::memcpy(data, s.data, s.size);
+
+    return {data, s.size};
+}
+
+void arena::release(const arena_string &s)
+{
+    if (s.size != 0)
+    {
+        deallocate(const_cast<char *>(s.data), s.size, 1);
+    }
+}
+
+allocation_statistics arena::statistics() const
+{
+    return statistics_;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,178 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/utils/allocation_statistics.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A string whose characters are owned by an arena. It stays valid for as long
+/// as the arena that stored it.
+/// </summary>
+struct arena_string
+{
+    const char *data;
+    std::size_t size;
+
+    /// <summary>
+    /// Returns a copy of the characters as a std::string.
+    /// </summary>
+    std::string str() const
+    {
+        return std::string(data, size);
+    }
+};
+
+/// <summary>
+/// A pooling allocator. Memory is carved out of progressively larger chunks and
+/// is only returned to the system, all at once, when the arena is destroyed.
+/// Deallocated blocks are kept on a free list for their size and handed out again
+/// by later allocations of the same size, so repeatedly replacing an entry doesn't
+/// grow the arena. Only trivially destructible objects or objects whose destructors
+/// don't need to run should be placed in an arena.
+/// </summary>
+class arena
+{
+public:
+    arena();
+
+    arena(const arena &) = delete;
+
+    arena &operator=(const arena &) = delete;
+
+    /// <summary>
+    /// Returns size bytes of uninitialized memory aligned to alignment.
+    /// </summary>
+    void *allocate(std::size_t size, std::size_t alignment);
+
+    /// <summary>
+    /// Returns memory obtained from allocate with the same size and alignment to
+    /// the arena so that it can be reused.
+    /// </summary>
+    void deallocate(void *memory, std::size_t size, std::size_t alignment);
+
+    /// <summary>
+    /// Copies the characters of s into the arena.
+    /// </summary>
+    arena_string store(const std::string &s);
+
+    /// <summary>
+    /// Copies the characters of s into the arena.
+    /// </summary>
+    arena_string store(const arena_string &s);
+
+    /// <summary>
+    /// Returns the characters of s, which must have been stored in this arena, so
+    /// that they can be reused. s must not be used afterwards.
+    /// </summary>
+    void release(const arena_string &s);
+
+    /// <summary>
+    /// Returns the number of bytes handed out and held by this arena.
+    /// </summary>
+    allocation_statistics statistics() const;
+
+private:
+    /// <summary>
+    /// A deallocated block, linked to the next free block of the same size.
+    /// </summary>
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    void add_chunk(std::size_t minimum_size);
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::size_t next_chunk_size_;
+
+    char *current_;
+    std::size_t remaining_;
+
+    std::unordered_map<std::size_t, free_block *> free_blocks_;
+
+    allocation_statistics statistics_;
+};
+
+/// <summary>
+/// Adapts an arena to the standard allocator interface so that containers can
+/// place their nodes in it. Deallocated nodes are reused by the arena.
+/// </summary>
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    explicit arena_allocator(arena &source)
+        : arena_(&source)
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &other)
+        : arena_(other.source())
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *memory, std::size_t n)
+    {
+        arena_->deallocate(memory, n * sizeof(T), alignof(T));
+    }
+
+    arena *source() const
+    {
+        return arena_;
+    }
+
+private:
+    arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T> &left, const arena_allocator<U> &right)
+{
+    return left.source() == right.source();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T> &left, const arena_allocator<U> &right)
+{
+    return !(left == right);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -29,12 +29,16 @@ namespace xlnt {
 namespace detail {
 
 cell_impl::cell_impl()
-    : type_(cell_type::empty),
-      parent_(nullptr),
-      column_(1),
+    : parent_(nullptr),
+      value_numeric_(0),
+      format_(nullptr),
       row_(1),
+      column_(1),
+      type_(cell_type::empty),
       is_merged_(false),
-      value_numeric_(0)
+      has_formula_(false),
+      has_hyperlink_(false),
+      has_comment_(false)
 {
 }
 
@@ -22,14 +22,10 @@
 // @author: see AUTHORS file
 #pragma once
 
-#include <cstddef>
-#include <string>
+#include <cstdint>
 
 #include <xlnt/cell/cell_type.hpp>
-#include <xlnt/cell/comment.hpp>
-#include <xlnt/cell/rich_text.hpp>
 #include <xlnt/cell/index_types.hpp>
-#include <xlnt/utils/optional.hpp>
 
 namespace xlnt {
 namespace detail {
@@ -37,26 +33,41 @@ namespace detail {
 struct format_impl;
 struct worksheet_impl;
 
+/// <summary>
+/// The compact record stored for every cell. Attributes that most cells don't
+/// have (formulas, hyperlinks, comments and non-shared text) live in side tables
+/// of the parent worksheet_impl keyed by key() and are flagged here.
+/// </summary>
 struct cell_impl
 {
     cell_impl();
 
-    cell_type type_;
+    /// <summary>
+    /// Returns a key uniquely identifying this cell's position in its worksheet.
+    /// </summary>
+    std::uint64_t key() const
+    {
+        return (static_cast<std::uint64_t>(row_) << 32) | column_.index;
+    }
 
     worksheet_impl *parent_;
 
-    column_t column_;
-    row_t row_;
+    /// <summary>
+    /// The numeric or boolean value, or the index into the shared string table.
+    /// </summary>
+    double value_numeric_;
 
-    bool is_merged_;
+    format_impl *format_;
 
-    rich_text value_text_;
-    long double value_numeric_;
+    row_t row_;
+    column_t column_;
+
+    cell_type type_;
 
-    optional<std::string> formula_;
-    optional<std::string> hyperlink_;
-    optional<format_impl *> format_;
-    optional<comment> comment_;
+    bool is_merged_;
+    bool has_formula_;
+    bool has_hyperlink_;
+    bool has_comment_;
 };
 
 } // namespace detail
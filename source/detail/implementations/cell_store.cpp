@@ -0,0 +1,492 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
+#include <detail/implementations/cell_store.hpp>
+#include <detail/implementations/stylesheet.hpp>
+
+namespace {
+
+xlnt::row_t block_start(xlnt::row_t row)
+{
+    return row - row % xlnt::detail::cell_store::rows_per_block;
+}
+
+bool entry_before(const xlnt::detail::cell_store::entry &e, xlnt::column_t::index_t column)
+{
+    return e.column < column;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const row_t cell_store::rows_per_block;
+
+static_assert(std::is_trivially_destructible<cell_impl>::value,
+    "cells are allocated from an arena and are never destroyed");
+
+cell_store::row_block::row_block(row_t first)
+    : first_row(first),
+      size(0)
+{
+}
+
+cell_impl *cell_store::allocate()
+{
+    if (!free_cells_.empty())
+    {
+        auto cell = free_cells_.back();
+        free_cells_.pop_back();
+
+        return cell;
+    }
+
+    // cell_impl is trivially destructible so it never has to be destroyed explicitly
+    return new (arena_.allocate(sizeof(cell_impl), alignof(cell_impl))) cell_impl();
+}
+
+void cell_store::release(cell_impl *cell)
+{
+    *cell = cell_impl();
+    free_cells_.push_back(cell);
+}
+
+cell_store::cell_store(worksheet_impl *owner)
+    : owner_(owner),
+      hint_(0),
+      size_(0),
+      first_row_(0),
+      last_row_(0),
+      first_column_(0),
+      last_column_(0)
+{
+}
+
+cell_store &cell_store::operator=(const cell_store &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+    blocks_.reserve(other.blocks_.size());
+
+    for (const auto &other_block : other.blocks_)
+    {
+        blocks_.emplace_back(new row_block(other_block->first_row));
+        auto &block = *blocks_.back();
+        block.size = other_block->size;
+
+        for (row_t offset = 0; offset < rows_per_block; ++offset)
+        {
+            const auto &other_cells = other_block->rows[offset];
+            auto &cells = block.rows[offset];
+            cells.reserve(other_cells.size());
+
+            for (const auto &e : other_cells)
+            {
+                auto cell = allocate();
+                *cell = *e.cell;
+                cell->parent_ = owner_;
+
+                if (cell->format_ != nullptr)
+                {
+                    // the copy is another reference to the format
+                    cell->format_->parent->retain(*cell->format_);
+                }
+                cells.push_back({e.column, cell});
+            }
+        }
+    }
+
+    hint_ = 0;
+    size_ = other.size_;
+    first_row_ = other.first_row_;
+    last_row_ = other.last_row_;
+    first_column_ = other.first_column_;
+    last_column_ = other.last_column_;
+
+    return *this;
+}
+
+cell_impl *cell_store::find_in_row(const cell_row &cells, column_t::index_t column)
+{
+    if (cells.empty() || column < cells.front().column || column > cells.back().column)
+    {
+        return nullptr;
+    }
+
+    // if the row is contiguous from its first column, the cell's position is known
+    const auto offset = static_cast<std::size_t>(column - cells.front().column);
+
+    if (offset < cells.size() && cells[offset].column == column)
+    {
+        return cells[offset].cell;
+    }
+
+    auto match = std::lower_bound(cells.begin(), cells.end(), column, entry_before);
+
+    return match != cells.end() && match->column == column ? match->cell : nullptr;
+}
+
+cell_store::row_block *cell_store::find_block(row_t row) const
+{
+    const auto first = block_start(row);
+
+    if (hint_ < blocks_.size() && blocks_[hint_]->first_row == first)
+    {
+        return blocks_[hint_].get();
+    }
+
+    auto match = first_block_at_or_after(row);
+
+    return match != blocks_.end() && (*match)->first_row == first ? match->get() : nullptr;
+}
+
+cell_store::block_list::const_iterator cell_store::first_block_at_or_after(row_t row) const
+{
+    return std::lower_bound(blocks_.begin(), blocks_.end(), block_start(row),
+        [](const std::unique_ptr<row_block> &block, row_t r) { return block->first_row < r; });
+}
+
+cell_store::row_block &cell_store::find_or_create_block(row_t row)
+{
+    const auto first = block_start(row);
+
+    if (hint_ < blocks_.size() && blocks_[hint_]->first_row == first)
+    {
+        return *blocks_[hint_];
+    }
+
+    auto match = std::lower_bound(blocks_.begin(), blocks_.end(), first,
+        [](const std::unique_ptr<row_block> &block, row_t r) { return block->first_row < r; });
+
+    if (match == blocks_.end() || (*match)->first_row != first)
+    {
+        match = blocks_.insert(match, std::unique_ptr<row_block>(new row_block(first)));
+    }
+
+    hint_ = static_cast<std::size_t>(match - blocks_.begin());
+
+    return **match;
+}
+
+void cell_store::remove_empty_blocks()
+{
+    blocks_.erase(std::remove_if(blocks_.begin(), blocks_.end(),
+                      [](const std::unique_ptr<row_block> &block) { return block->size == 0; }),
+        blocks_.end());
+    hint_ = 0;
+}
+
+cell_impl *cell_store::find(row_t row, column_t::index_t column)
+{
+    auto block = find_block(row);
+
+    return block == nullptr ? nullptr : find_in_row(block->rows[row - block->first_row], column);
+}
+
+const cell_impl *cell_store::find(row_t row, column_t::index_t column) const
+{
+    auto block = find_block(row);
+
+    return block == nullptr ? nullptr : find_in_row(block->rows[row - block->first_row], column);
+}
+
+cell_impl *cell_store::create(row_t row, column_t::index_t column)
+{
+    auto &block = find_or_create_block(row);
+    auto &cells = block.rows[row - block.first_row];
+    auto position = cells.end();
+
+    if (!cells.empty() && column <= cells.back().column)
+    {
+        position = std::lower_bound(cells.begin(), cells.end(), column, entry_before);
+
+        if (position->column == column)
+        {
+            return position->cell;
+        }
+    }
+
+    auto cell = allocate();
+    ++block.size;
+    cell->parent_ = owner_;
+    cell->row_ = row;
+    cell->column_ = column;
+    cells.insert(position, {column, cell});
+
+    if (size_++ == 0)
+    {
+        first_row_ = last_row_ = row;
+        first_column_ = last_column_ = column;
+    }
+    else
+    {
+        first_row_ = std::min(first_row_, row);
+        last_row_ = std::max(last_row_, row);
+        first_column_ = std::min(first_column_, column);
+        last_column_ = std::max(last_column_, column);
+    }
+
+    return cell;
+}
+
+const cell_store::cell_row *cell_store::find_row(row_t row) const
+{
+    auto block = find_block(row);
+
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+
+    const auto &cells = block->rows[row - block->first_row];
+
+    return cells.empty() ? nullptr : &cells;
+}
+
+bool cell_store::has_cell_in_row(row_t row, column_t::index_t first, column_t::index_t last) const
+{
+    return next_column(row, first, last) != 0;
+}
+
+bool cell_store::has_cell_in_column(column_t::index_t column, row_t first, row_t last) const
+{
+    return next_row(first, last, column, column) != 0;
+}
+
+column_t::index_t cell_store::next_column(row_t row, column_t::index_t first, column_t::index_t last) const
+{
+    auto cells = find_row(row);
+
+    if (cells == nullptr)
+    {
+        return 0;
+    }
+
+    auto match = std::lower_bound(cells->begin(), cells->end(), first, entry_before);
+
+    return match != cells->end() && match->column <= last ? match->column : 0;
+}
+
+column_t::index_t cell_store::previous_column(row_t row, column_t::index_t first, column_t::index_t last) const
+{
+    auto cells = find_row(row);
+
+    if (cells == nullptr)
+    {
+        return 0;
+    }
+
+    auto match = std::upper_bound(cells->begin(), cells->end(), last,
+        [](column_t::index_t column, const entry &e) { return column < e.column; });
+
+    if (match == cells->begin())
+    {
+        return 0;
+    }
+
+    --match;
+
+    return match->column >= first ? match->column : 0;
+}
+
+row_t cell_store::next_row(row_t first, row_t last, column_t::index_t first_column, column_t::index_t last_column) const
+{
+    for (auto block = first_block_at_or_after(first); block != blocks_.end() && (*block)->first_row <= last; ++block)
+    {
+        const auto &rows = (*block)->rows;
+        const auto start = std::max(first, (*block)->first_row);
+
+        for (auto row = start; row < (*block)->first_row + rows_per_block && row <= last; ++row)
+        {
+            const auto &cells = rows[row - (*block)->first_row];
+
+            if (cells.empty() || cells.back().column < first_column || cells.front().column > last_column)
+            {
+                continue;
+            }
+
+            auto match = std::lower_bound(cells.begin(), cells.end(), first_column, entry_before);
+
+            if (match != cells.end() && match->column <= last_column)
+            {
+                return row;
+            }
+        }
+    }
+
+    return 0;
+}
+
+row_t cell_store::previous_row(row_t first, row_t last, column_t::index_t first_column, column_t::index_t last_column) const
+{
+    auto block = std::upper_bound(blocks_.begin(), blocks_.end(), last,
+        [](row_t r, const std::unique_ptr<row_block> &b) { return r < b->first_row; });
+
+    while (block != blocks_.begin())
+    {
+        --block;
+
+        if ((*block)->first_row + rows_per_block <= first)
+        {
+            break;
+        }
+
+        const auto &rows = (*block)->rows;
+        const auto start = std::min(last, (*block)->first_row + rows_per_block - 1);
+
+        for (auto row = start; row >= first && row >= (*block)->first_row; --row)
+        {
+            const auto &cells = rows[row - (*block)->first_row];
+
+            if (!cells.empty() && cells.back().column >= first_column && cells.front().column <= last_column)
+            {
+                auto match = std::lower_bound(cells.begin(), cells.end(), first_column, entry_before);
+
+                if (match != cells.end() && match->column <= last_column)
+                {
+                    return row;
+                }
+            }
+
+            if (row == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+row_t cell_store::first_row() const
+{
+    return first_row_;
+}
+
+row_t cell_store::last_row() const
+{
+    return last_row_;
+}
+
+column_t::index_t cell_store::first_column() const
+{
+    return first_column_;
+}
+
+column_t::index_t cell_store::last_column() const
+{
+    return last_column_;
+}
+
+void cell_store::recalculate_bounds()
+{
+    if (blocks_.empty())
+    {
+        return;
+    }
+
+    const auto &first_block = *blocks_.front();
+    row_t offset = 0;
+
+    while (first_block.rows[offset].empty())
+    {
+        ++offset;
+    }
+
+    first_row_ = first_block.first_row + offset;
+
+    const auto &last_block = *blocks_.back();
+    offset = rows_per_block - 1;
+
+    while (last_block.rows[offset].empty())
+    {
+        --offset;
+    }
+
+    last_row_ = last_block.first_row + offset;
+
+    // rows are sorted by column so only their ends need to be looked at
+    first_column_ = first_block.rows[first_row_ - first_block.first_row].front().column;
+    last_column_ = first_column_;
+
+    for_each_row([this](row_t, const cell_row &cells) {
+        first_column_ = std::min(first_column_, cells.front().column);
+        last_column_ = std::max(last_column_, cells.back().column);
+    });
+}
+
+std::size_t cell_store::size() const
+{
+    return size_;
+}
+
+bool cell_store::empty() const
+{
+    return size_ == 0;
+}
+
+void cell_store::clear()
+{
+    for (const auto &block : blocks_)
+    {
+        for (const auto &cells : block->rows)
+        {
+            for (const auto &e : cells)
+            {
+                release(e.cell);
+            }
+        }
+    }
+
+    blocks_.clear();
+    hint_ = 0;
+    size_ = 0;
+}
+
+allocation_statistics cell_store::statistics() const
+{
+    return arena_.statistics();
+}
+
+void cell_store::reserve(std::size_t rows)
+{
+    blocks_.reserve(rows / rows_per_block + 1);
+}
+
+void cell_store::reserve_row(row_t row, std::size_t additional)
+{
+    auto &block = find_or_create_block(row);
+    auto &cells = block.rows[row - block.first_row];
+    cells.reserve(cells.size() + additional);
+}
+
+} // namespace detail
+} // namespace xlnt
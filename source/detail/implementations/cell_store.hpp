@@ -0,0 +1,383 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <detail/implementations/arena.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/utils/allocation_statistics.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Owns the cells of a worksheet. Rows are grouped into blocks of rows_per_block
+/// consecutive rows and the blocks are kept in a directory sorted by row. Each row
+/// keeps its cells sorted by column so contiguous rows can be indexed directly and
+/// sparse rows can be binary searched. Cells are allocated from an arena owned by
+/// the store so pointers to them stay valid until the cell itself is erased.
+/// Erased cells are recycled by later insertions.
+/// </summary>
+class cell_store
+{
+public:
+    /// <summary>
+    /// The number of consecutive rows grouped together in one block.
+    /// </summary>
+    static const row_t rows_per_block = 32;
+
+    /// <summary>
+    /// A cell together with its column. Keeping the column next to the pointer
+    /// means searching a row never has to touch the cells themselves.
+    /// </summary>
+    struct entry
+    {
+        column_t::index_t column;
+        cell_impl *cell;
+    };
+
+    /// <summary>
+    /// The cells of a single row in increasing column order.
+    /// </summary>
+    using cell_row = std::vector<entry>;
+
+    /// <summary>
+    /// Constructs an empty store whose cells will belong to the worksheet owner.
+    /// </summary>
+    explicit cell_store(worksheet_impl *owner);
+
+    cell_store(const cell_store &other) = delete;
+
+    /// <summary>
+    /// Replaces the cells in this store with copies of the cells in other. The
+    /// copies belong to this store's worksheet.
+    /// </summary>
+    cell_store &operator=(const cell_store &other);
+
+    /// <summary>
+    /// Returns the cell at the given position or nullptr if it doesn't exist.
+    /// </summary>
+    cell_impl *find(row_t row, column_t::index_t column);
+
+    /// <summary>
+    /// Returns the cell at the given position or nullptr if it doesn't exist.
+    /// </summary>
+    const cell_impl *find(row_t row, column_t::index_t column) const;
+
+    /// <summary>
+    /// Returns the cell at the given position, creating it first if it doesn't exist.
+    /// </summary>
+    cell_impl *create(row_t row, column_t::index_t column);
+
+    /// <summary>
+    /// Returns the cells in the given row or nullptr if the row has no cells.
+    /// </summary>
+    const cell_row *find_row(row_t row) const;
+
+    /// <summary>
+    /// Returns true if any cell exists in row between the columns first and last inclusive.
+    /// </summary>
+    bool has_cell_in_row(row_t row, column_t::index_t first, column_t::index_t last) const;
+
+    /// <summary>
+    /// Returns true if any cell exists in column between the rows first and last inclusive.
+    /// </summary>
+    bool has_cell_in_column(column_t::index_t column, row_t first, row_t last) const;
+
+    /// <summary>
+    /// Returns the column of the first cell in row with a column between first and last
+    /// inclusive, or 0 if there is no such cell.
+    /// </summary>
+    column_t::index_t next_column(row_t row, column_t::index_t first, column_t::index_t last) const;
+
+    /// <summary>
+    /// Returns the column of the last cell in row with a column between first and last
+    /// inclusive, or 0 if there is no such cell.
+    /// </summary>
+    column_t::index_t previous_column(row_t row, column_t::index_t first, column_t::index_t last) const;
+
+    /// <summary>
+    /// Returns the first row between first and last inclusive that has a cell with a column
+    /// between first_column and last_column inclusive, or 0 if there is no such row.
+    /// Blocks without cells are skipped entirely.
+    /// </summary>
+    row_t next_row(row_t first, row_t last, column_t::index_t first_column, column_t::index_t last_column) const;
+
+    /// <summary>
+    /// Returns the last row between first and last inclusive that has a cell with a column
+    /// between first_column and last_column inclusive, or 0 if there is no such row.
+    /// Blocks without cells are skipped entirely.
+    /// </summary>
+    row_t previous_row(row_t first, row_t last, column_t::index_t first_column, column_t::index_t last_column) const;
+
+    /// <summary>
+    /// Returns the index of the first row containing a cell. The store must not be empty.
+    /// </summary>
+    row_t first_row() const;
+
+    /// <summary>
+    /// Returns the index of the last row containing a cell. The store must not be empty.
+    /// </summary>
+    row_t last_row() const;
+
+    /// <summary>
+    /// Returns the index of the first column containing a cell. The store must not be empty.
+    /// </summary>
+    column_t::index_t first_column() const;
+
+    /// <summary>
+    /// Returns the index of the last column containing a cell. The store must not be empty.
+    /// </summary>
+    column_t::index_t last_column() const;
+
+    /// <summary>
+    /// Returns the number of cells in the store.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Returns true if the store contains no cells.
+    /// </summary>
+    bool empty() const;
+
+    /// <summary>
+    /// Removes all cells. Their memory is kept for reuse.
+    /// </summary>
+    void clear();
+
+    /// <summary>
+    /// Preallocates the row directory for the given number of rows.
+    /// </summary>
+    void reserve(std::size_t rows);
+
+    /// <summary>
+    /// Preallocates room for additional more cells in row.
+    /// </summary>
+    void reserve_row(row_t row, std::size_t additional);
+
+    /// <summary>
+    /// Returns the memory held by this store's arena.
+    /// </summary>
+    allocation_statistics statistics() const;
+
+    /// <summary>
+    /// Calls f with every cell in row-major order.
+    /// </summary>
+    template <typename Function>
+    void for_each(Function f)
+    {
+        for (auto &block : blocks_)
+        {
+            for (auto &cells : block->rows)
+            {
+                for (auto &e : cells)
+                {
+                    f(*e.cell);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Calls f with every cell in row-major order.
+    /// </summary>
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for (const auto &block : blocks_)
+        {
+            for (const auto &cells : block->rows)
+            {
+                for (const auto &e : cells)
+                {
+                    f(static_cast<const cell_impl &>(*e.cell));
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Calls f with the index and cells of every non-empty row in increasing row order.
+    /// </summary>
+    template <typename Function>
+    void for_each_row(Function f) const
+    {
+        for (const auto &block : blocks_)
+        {
+            for (row_t offset = 0; offset < rows_per_block; ++offset)
+            {
+                if (!block->rows[offset].empty())
+                {
+                    f(block->first_row + offset, block->rows[offset]);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Calls f with the row and cell of every cell in column between the rows first and
+    /// last inclusive in increasing row order. Blocks without cells are skipped entirely.
+    /// </summary>
+    template <typename Function>
+    void for_each_in_column(column_t::index_t column, row_t first, row_t last, Function f) const
+    {
+        for (auto block = first_block_at_or_after(first); block != blocks_.end() && (*block)->first_row <= last; ++block)
+        {
+            for (row_t offset = 0; offset < rows_per_block; ++offset)
+            {
+                const auto row = (*block)->first_row + offset;
+
+                if (row < first || row > last)
+                {
+                    continue;
+                }
+
+                auto cell = find_in_row((*block)->rows[offset], column);
+
+                if (cell != nullptr)
+                {
+                    f(row, static_cast<const cell_impl &>(*cell));
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Erases every cell for which predicate returns true and returns the number erased.
+    /// </summary>
+    template <typename Predicate>
+    std::size_t erase_if(Predicate predicate)
+    {
+        std::size_t erased = 0;
+
+        for (auto &block : blocks_)
+        {
+            for (auto &cells : block->rows)
+            {
+                auto kept = cells.begin();
+
+                for (auto &e : cells)
+                {
+                    if (predicate(*e.cell))
+                    {
+                        --block->size;
+                        release(e.cell);
+                        ++erased;
+                    }
+                    else
+                    {
+                        *kept++ = e;
+                    }
+                }
+
+                cells.erase(kept, cells.end());
+            }
+        }
+
+        if (erased > 0)
+        {
+            size_ -= erased;
+            remove_empty_blocks();
+            recalculate_bounds();
+        }
+
+        return erased;
+    }
+
+private:
+    /// <summary>
+    /// A group of rows_per_block consecutive rows.
+    /// </summary>
+    struct row_block
+    {
+        explicit row_block(row_t first);
+
+        row_t first_row;
+        std::size_t size;
+        std::array<cell_row, rows_per_block> rows;
+    };
+
+    using block_list = std::vector<std::unique_ptr<row_block>>;
+
+    cell_impl *allocate();
+
+    /// <summary>
+    /// Returns cell to the free list.
+    /// </summary>
+    void release(cell_impl *cell);
+
+    row_block *find_block(row_t row) const;
+
+    /// <summary>
+    /// Returns an iterator to the first block that contains row or comes after it.
+    /// </summary>
+    block_list::const_iterator first_block_at_or_after(row_t row) const;
+
+    /// <summary>
+    /// Returns the block containing row, creating it if it doesn't exist.
+    /// </summary>
+    row_block &find_or_create_block(row_t row);
+
+    void remove_empty_blocks();
+
+    /// <summary>
+    /// Recomputes the bounding box from the rows after cells were erased.
+    /// </summary>
+    void recalculate_bounds();
+
+    static cell_impl *find_in_row(const cell_row &cells, column_t::index_t column);
+
+    worksheet_impl *owner_;
+
+    arena arena_;
+
+    block_list blocks_;
+
+    /// <summary>
+    /// Cells that were erased and can be handed out again.
+    /// </summary>
+    std::vector<cell_impl *> free_cells_;
+
+    /// <summary>
+    /// Index of the block last written to. Cells are usually created row by row
+    /// so this saves a search of the directory for most insertions.
+    /// </summary>
+    std::size_t hint_;
+
+    std::size_t size_;
+
+    // The bounding box of all cells, maintained on insertion so that it can be
+    // queried in constant time. Only meaningful while size_ > 0.
+    row_t first_row_;
+    row_t last_row_;
+    column_t::index_t first_column_;
+    column_t::index_t last_column_;
+};
+
+} // namespace detail
+} // namespace xlnt
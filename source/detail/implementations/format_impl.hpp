@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 
+#include <detail/hash_combine.hpp>
 #include <xlnt/styles/alignment.hpp>
 #include <xlnt/styles/border.hpp>
 #include <xlnt/styles/fill.hpp>
@@ -77,3 +79,41 @@ struct format_impl
 
 } // namespace detail
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Hashes the fields of a format_impl that operator== compares, other than parent.
+/// </summary>
+template <>
+struct hash<xlnt::detail::format_impl>
+{
+    size_t operator()(const xlnt::detail::format_impl &f) const
+    {
+        size_t seed = 0;
+
+        for (const auto &id : {f.alignment_id, f.border_id, f.fill_id, f.font_id, f.number_format_id, f.protection_id})
+        {
+            xlnt::detail::hash_combine(seed, id.is_set() ? id.get() : static_cast<size_t>(-1));
+        }
+
+        const auto flags = static_cast<size_t>(f.alignment_applied)
+            | static_cast<size_t>(f.border_applied) << 1
+            | static_cast<size_t>(f.fill_applied) << 2
+            | static_cast<size_t>(f.font_applied) << 3
+            | static_cast<size_t>(f.number_format_applied) << 4
+            | static_cast<size_t>(f.protection_applied) << 5
+            | static_cast<size_t>(f.pivot_button_) << 6
+            | static_cast<size_t>(f.quote_prefix_) << 7;
+        xlnt::detail::hash_combine(seed, flags);
+
+        if (f.style.is_set())
+        {
+            xlnt::detail::hash_combine(seed, f.style.get());
+        }
+
+        return seed;
+    }
+};
+
+} // namespace std
@@ -0,0 +1,294 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <cctype>
+
+#include <detail/constants.hpp>
+#include <detail/implementations/shared_formula.hpp>
+
+namespace {
+
+/// <summary>
+/// An A1-style reference found in a formula. One end of a whole-row range such as
+/// 1:3 has no column part and one end of a whole-column range such as A:C has no
+/// row part. A missing part is zero.
+/// </summary>
+struct formula_reference
+{
+    bool absolute_column;
+    xlnt::column_t::index_t column;
+    bool absolute_row;
+    xlnt::row_t row;
+};
+
+bool is_name_character(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return u >= 0x80 || std::isalnum(u) || c == '_' || c == '.' || c == '\\';
+}
+
+/// <summary>
+/// Tries to read the column part of a reference, such as A or $A, starting at i.
+/// On success, moves i past it and returns true.
+/// </summary>
+bool read_column(const std::string &formula, std::size_t &i, formula_reference &reference)
+{
+    auto j = i;
+
+    reference.absolute_column = j < formula.size() && formula[j] == '$';
+    if (reference.absolute_column) ++j;
+
+    const auto column_start = j;
+
+    while (j < formula.size() && std::isalpha(static_cast<unsigned char>(formula[j])) && j - column_start < 4)
+    {
+        ++j;
+    }
+
+    const auto column_length = j - column_start;
+
+    if (column_length == 0 || column_length > 3)
+    {
+        return false;
+    }
+
+    std::string column_string(formula, column_start, column_length);
+
+    for (auto &c : column_string)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    reference.column = xlnt::column_t::column_index_from_string(column_string);
+    i = j;
+
+    return true;
+}
+
+/// <summary>
+/// Tries to read the row part of a reference, such as 1 or $1, starting at i.
+/// On success, moves i past it and returns true.
+/// </summary>
+bool read_row(const std::string &formula, std::size_t &i, formula_reference &reference)
+{
+    auto j = i;
+
+    reference.absolute_row = j < formula.size() && formula[j] == '$';
+    if (reference.absolute_row) ++j;
+
+    const auto row_start = j;
+
+    while (j < formula.size() && std::isdigit(static_cast<unsigned char>(formula[j])))
+    {
+        ++j;
+    }
+
+    const auto row_length = j - row_start;
+
+    if (row_length == 0 || row_length > 7 || formula[row_start] == '0')
+    {
+        return false;
+    }
+
+    reference.row = static_cast<xlnt::row_t>(std::stoul(formula.substr(row_start, row_length)));
+    i = j;
+
+    return true;
+}
+
+/// <summary>
+/// Returns true if a reference may end at position, i.e. it isn't followed by
+/// something that would make it part of a longer name, a function call or a sheet name.
+/// </summary>
+bool ends_reference(const std::string &formula, std::size_t position)
+{
+    return position >= formula.size()
+        || !(is_name_character(formula[position]) || formula[position] == '('
+            || formula[position] == '!' || formula[position] == '$');
+}
+
+/// <summary>
+/// Tries to read a cell reference such as A1, $A1, A$1 or $A$1 starting at
+/// position. On success, sets end to one past the reference and returns true.
+/// Function names like LOG10( and sheet names like Q1! are not references.
+/// </summary>
+bool read_reference(const std::string &formula, std::size_t position, formula_reference &reference, std::size_t &end)
+{
+    auto i = position;
+
+    if (!read_column(formula, i, reference) || !read_row(formula, i, reference) || !ends_reference(formula, i))
+    {
+        return false;
+    }
+
+    end = i;
+
+    return true;
+}
+
+/// <summary>
+/// Tries to read a whole-row range such as 1:3 or $2:$2, or a whole-column range
+/// such as A:C or $B:$B, starting at position. On success, sets end to one past
+/// the range and returns true.
+/// </summary>
+bool read_line_range(const std::string &formula, std::size_t position,
+    formula_reference &first, formula_reference &last, std::size_t &end)
+{
+    first = last = formula_reference();
+
+    for (auto rows : { true, false })
+    {
+        auto i = position;
+        auto read_part = rows ? read_row : read_column;
+
+        if (read_part(formula, i, first) && i < formula.size() && formula[i] == ':'
+            && read_part(formula, ++i, last) && ends_reference(formula, i))
+        {
+            end = i;
+            return true;
+        }
+
+        first = last = formula_reference();
+    }
+
+    return false;
+}
+
+/// <summary>
+/// Copies formula to the result, replacing each cell reference outside of string
+/// literals and quoted sheet names with the result of rewrite.
+/// </summary>
+template <typename F>
+std::string rewrite_references(const std::string &formula, F rewrite)
+{
+    std::string result;
+    result.reserve(formula.size());
+
+    std::size_t i = 0;
+
+    while (i < formula.size())
+    {
+        const auto c = formula[i];
+
+        if (c == '"' || c == '\'')
+        {
+            // a doubled quote is an escaped quote, so both halves are copied in turn
+            auto close = formula.find(c, i + 1);
+            close = close == std::string::npos ? formula.size() : close + 1;
+            result.append(formula, i, close - i);
+            i = close;
+
+            continue;
+        }
+
+        auto reference = formula_reference();
+        auto last = formula_reference();
+        auto end = std::size_t(0);
+        const auto at_start = i == 0 || (!is_name_character(formula[i - 1]) && formula[i - 1] != '$');
+
+        if (at_start && read_line_range(formula, i, reference, last, end))
+        {
+            // a range with an end moved off the sheet is #REF! as a whole
+            const auto first_part = rewrite(reference);
+            const auto last_part = rewrite(last);
+            result.append(first_part == "#REF!" || last_part == "#REF!" ? "#REF!" : first_part + ":" + last_part);
+            i = end;
+
+            continue;
+        }
+
+        if (at_start && read_reference(formula, i, reference, end))
+        {
+            result.append(rewrite(reference));
+            i = end;
+
+            continue;
+        }
+
+        result.push_back(c);
+        ++i;
+    }
+
+    return result;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+std::string translate_formula(const std::string &formula, std::int64_t row_offset, std::int64_t column_offset)
+{
+    if (row_offset == 0 && column_offset == 0)
+    {
+        return formula;
+    }
+
+    return rewrite_references(formula, [=](const formula_reference &reference) {
+        // a missing part stays missing, so it is neither moved nor checked
+        const auto column = reference.absolute_column || reference.column == 0
+            ? static_cast<std::int64_t>(reference.column) : reference.column + column_offset;
+        const auto row = reference.absolute_row || reference.row == 0
+            ? static_cast<std::int64_t>(reference.row) : reference.row + row_offset;
+
+        if ((reference.column != 0 && column < 1) || (reference.row != 0 && row < 1)
+            || column > static_cast<std::int64_t>(constants::max_column().index)
+            || row > static_cast<std::int64_t>(constants::max_row()))
+        {
+            return std::string("#REF!");
+        }
+
+        std::string result;
+
+        if (reference.column != 0)
+        {
+            result.append(reference.absolute_column ? "$" : "");
+            result.append(column_t::column_string_from_index(static_cast<column_t::index_t>(column)));
+        }
+
+        if (reference.row != 0)
+        {
+            result.append(reference.absolute_row ? "$" : "");
+            result.append(std::to_string(row));
+        }
+
+        return result;
+    });
+}
+
+std::string relative_formula(const std::string &formula, row_t row, column_t::index_t column)
+{
+    // the unit separator cannot appear in a formula, so the encoded references are unambiguous
+    return rewrite_references(formula, [=](const formula_reference &reference) {
+        const auto column_part = reference.column == 0 ? std::string()
+            : reference.absolute_column ? "C" + std::to_string(reference.column)
+            : "C[" + std::to_string(static_cast<std::int64_t>(reference.column) - column) + "]";
+        const auto row_part = reference.row == 0 ? std::string()
+            : reference.absolute_row ? "R" + std::to_string(reference.row)
+            : "R[" + std::to_string(static_cast<std::int64_t>(reference.row) - row) + "]";
+
+        return '\x1f' + row_part + column_part + '\x1f';
+    });
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,62 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <detail/implementations/arena.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The master of a group of cells sharing one formula. Every other cell of the
+/// group uses the same formula with its relative references moved by the cell's
+/// offset from the master.
+/// </summary>
+struct shared_formula
+{
+    row_t row;
+    column_t::index_t column;
+    arena_string formula;
+};
+
+/// <summary>
+/// Returns formula with the relative parts of each A1-style cell reference and
+/// whole-row or whole-column range moved by the given number of rows and columns,
+/// as happens when a formula is filled into another cell. References that move off
+/// the sheet become #REF!.
+/// </summary>
+std::string translate_formula(const std::string &formula, std::int64_t row_offset, std::int64_t column_offset);
+
+/// <summary>
+/// Returns a form of formula, as entered at row and column, in which relative
+/// references are replaced by their offsets from that cell. Two formulas that
+/// would be produced from each other by filling have the same relative form.
+/// </summary>
+std::string relative_formula(const std::string &formula, row_t row, column_t::index_t column);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,241 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <cstdint>
+
+#include <detail/implementations/shared_string_table.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace {
+
+bool is_plain(const std::vector<xlnt::rich_text_run> &runs)
+{
+    return runs.size() == 1 && !runs.front().second.is_set();
+}
+
+// FNV-1a, so that stored characters can be hashed without copying them into a std::string
+std::size_t hash_characters(const char *data, std::size_t size)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return static_cast<std::size_t>(hash);
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+shared_string_table::shared_string_table()
+    : owns_last_segment_(false),
+      size_(0)
+{
+}
+
+shared_string_table::shared_string_table(const shared_string_table &other)
+    : shared_string_table()
+{
+    *this = other;
+}
+
+shared_string_table &shared_string_table::operator=(const shared_string_table &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    // the segments are shared, so neither table may append to the last one any more
+    if (!other.segments_.empty())
+    {
+        other.segments_.back().data->sealed = true;
+    }
+
+    segments_ = other.segments_;
+    owns_last_segment_ = false;
+    size_ = other.size_;
+
+    return *this;
+}
+
+std::size_t shared_string_table::add(const rich_text &shared, bool allow_duplicates)
+{
+    const auto runs = shared.runs();
+    const auto plain = is_plain(runs);
+    const auto plain_text = plain ? runs.front().first : shared.plain_text();
+    const auto hash = hash_characters(plain_text.data(), plain_text.size());
+
+    if (!allow_duplicates)
+    {
+        for (const auto &view : segments_)
+        {
+            const auto &data = *view.data;
+
+            // duplicates added with allow_duplicates share a hash, so keep the earliest match
+            auto candidates = data.index.equal_range(hash);
+            auto match = view.size;
+
+            for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+            {
+                const auto local = candidate->second;
+
+                if (local >= match)
+                {
+                    continue;
+                }
+
+                const auto &entry = data.entries[local];
+
+                if (string_view(entry.data, entry.size) != string_view(plain_text))
+                {
+                    continue;
+                }
+
+                auto rich = data.rich_entries.find(local);
+                const auto is_rich_entry = rich != data.rich_entries.end();
+
+                if (plain ? !is_rich_entry : is_rich_entry && rich->second == shared)
+                {
+                    match = local;
+                }
+            }
+
+            if (match != view.size)
+            {
+                return view.first + match;
+            }
+        }
+    }
+
+    if (!owns_last_segment_ || segments_.back().data->sealed)
+    {
+        segments_.push_back(segment_view{std::make_shared<segment>(), size_, 0});
+        owns_last_segment_ = true;
+    }
+
+    auto &view = segments_.back();
+    auto &data = *view.data;
+    const auto local = data.entries.size();
+
+    data.entries.push_back(data.characters.store(plain_text));
+    data.index.emplace(hash, local);
+
+    if (!plain)
+    {
+        data.rich_entries.emplace(local, shared);
+    }
+
+    ++view.size;
+
+    return size_++;
+}
+
+const shared_string_table::segment_view &shared_string_table::find(std::size_t index, std::size_t &local) const
+{
+    if (index >= size_)
+    {
+        throw invalid_parameter();
+    }
+
+    // there is one segment per generation of copies, so this is usually the last one
+    auto view = segments_.rbegin();
+
+    while (view->first > index)
+    {
+        ++view;
+    }
+
+    local = index - view->first;
+
+    return *view;
+}
+
+rich_text shared_string_table::at(std::size_t index) const
+{
+    auto local = std::size_t(0);
+    const auto &data = *find(index, local).data;
+    auto rich = data.rich_entries.find(local);
+
+    if (rich != data.rich_entries.end())
+    {
+        return rich->second;
+    }
+
+    const auto &entry = data.entries[local];
+
+    return rich_text(std::string(entry.data, entry.size));
+}
+
+string_view shared_string_table::text(std::size_t index) const
+{
+    auto local = std::size_t(0);
+    const auto &data = *find(index, local).data;
+    const auto &entry = data.entries[local];
+
+    return string_view(entry.data, entry.size);
+}
+
+bool shared_string_table::is_rich(std::size_t index) const
+{
+    auto local = std::size_t(0);
+    const auto &data = *find(index, local).data;
+
+    return !data.rich_entries.empty() && data.rich_entries.find(local) != data.rich_entries.end();
+}
+
+std::size_t shared_string_table::size() const
+{
+    return size_;
+}
+
+bool shared_string_table::empty() const
+{
+    return size_ == 0;
+}
+
+void shared_string_table::clear()
+{
+    segments_.clear();
+    owns_last_segment_ = false;
+    size_ = 0;
+}
+
+allocation_statistics shared_string_table::statistics() const
+{
+    allocation_statistics statistics;
+
+    if (owns_last_segment_)
+    {
+        statistics += segments_.back().data->characters.statistics();
+    }
+
+    return statistics;
+}
+
+} // namespace detail
+} // namespace xlnt
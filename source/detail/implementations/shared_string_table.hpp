@@ -0,0 +1,162 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/implementations/arena.hpp>
+#include <xlnt/cell/rich_text.hpp>
+#include <xlnt/utils/allocation_statistics.hpp>
+#include <xlnt/utils/string_view.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The shared strings of a workbook. The plain text of every entry is stored
+/// back to back in an arena and addressed through a table of offsets, so a plain
+/// string costs its characters plus one table entry. Entries with formatting keep
+/// their full rich_text in a side table keyed by position.
+///
+/// The entries are held in segments that copies of the table share. Copying seals
+/// the last segment, so it is never changed again while other tables read it, and
+/// both tables append their later entries to new segments of their own. Copying
+/// therefore never duplicates the strings.
+/// </summary>
+class shared_string_table
+{
+public:
+    shared_string_table();
+
+    shared_string_table(const shared_string_table &other);
+
+    shared_string_table &operator=(const shared_string_table &other);
+
+    /// <summary>
+    /// Appends shared and returns its position. Unless allow_duplicates is true,
+    /// the position of an equal existing entry is returned instead.
+    /// </summary>
+    std::size_t add(const rich_text &shared, bool allow_duplicates);
+
+    /// <summary>
+    /// Returns the entry at index, including any formatting.
+    /// Throws invalid_parameter if index is out of range.
+    /// </summary>
+    rich_text at(std::size_t index) const;
+
+    /// <summary>
+    /// Returns a view of the plain text of the entry at index. The view stays
+    /// valid until the table is cleared or destroyed.
+    /// Throws invalid_parameter if index is out of range.
+    /// </summary>
+    string_view text(std::size_t index) const;
+
+    /// <summary>
+    /// Returns true if the entry at index has formatting or more than one run.
+    /// </summary>
+    bool is_rich(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the number of entries.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Returns true if there are no entries.
+    /// </summary>
+    bool empty() const;
+
+    /// <summary>
+    /// Removes every entry. Segments shared with copies of this table live on in them.
+    /// </summary>
+    void clear();
+
+    /// <summary>
+    /// Returns the memory held by the character storage of the segments this table
+    /// created. Segments it shares with the table it was copied from aren't counted.
+    /// </summary>
+    allocation_statistics statistics() const;
+
+private:
+    /// <summary>
+    /// Consecutive entries and their index. Only the table that created a segment
+    /// appends to it, and only until the segment is sealed by a copy.
+    /// </summary>
+    struct segment
+    {
+        /// <summary>
+        /// Set when a table is copied, possibly from another thread than the one of the
+        /// table appending to the segment.
+        /// </summary>
+        std::atomic<bool> sealed{false};
+
+        arena characters;
+        std::vector<arena_string> entries;
+        std::unordered_map<std::size_t, rich_text> rich_entries;
+
+        /// <summary>
+        /// Maps the hash of each entry's text to its position in entries.
+        /// </summary>
+        std::unordered_multimap<std::size_t, std::size_t> index;
+    };
+
+    /// <summary>
+    /// The part of a segment visible to this table.
+    /// </summary>
+    struct segment_view
+    {
+        std::shared_ptr<segment> data;
+
+        /// <summary>
+        /// The table position of the first entry of the segment.
+        /// </summary>
+        std::size_t first;
+
+        /// <summary>
+        /// The number of entries of the segment that belong to this table.
+        /// </summary>
+        std::size_t size;
+    };
+
+    /// <summary>
+    /// Returns the view containing the entry at index and sets local to its position
+    /// in that segment. Throws invalid_parameter if index is out of range.
+    /// </summary>
+    const segment_view &find(std::size_t index, std::size_t &local) const;
+
+    std::vector<segment_view> segments_;
+
+    /// <summary>
+    /// True if this table created the last segment. It may append to it while it isn't sealed.
+    /// </summary>
+    bool owns_last_segment_;
+
+    std::size_t size_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,189 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A sequence of separately allocated elements. Unlike std::vector, elements keep
+/// their addresses while the sequence grows or is compacted, so they can be pointed
+/// to from elsewhere, and unlike std::list, they can be reached by position in
+/// constant time. Copying the sequence copies the elements.
+/// </summary>
+template <typename T>
+class stable_vector
+{
+    using storage = std::vector<std::unique_ptr<T>>;
+
+    /// <summary>
+    /// Adapts an iterator over the element pointers to one over the elements.
+    /// </summary>
+    template <typename Iterator, typename Value>
+    class element_iterator
+    {
+    public:
+        explicit element_iterator(Iterator position)
+            : position_(position)
+        {
+        }
+
+        Value &operator*() const
+        {
+            return **position_;
+        }
+
+        Value *operator->() const
+        {
+            return position_->get();
+        }
+
+        element_iterator &operator++()
+        {
+            ++position_;
+            return *this;
+        }
+
+        bool operator==(const element_iterator &other) const
+        {
+            return position_ == other.position_;
+        }
+
+        bool operator!=(const element_iterator &other) const
+        {
+            return position_ != other.position_;
+        }
+
+    private:
+        Iterator position_;
+    };
+
+public:
+    using iterator = element_iterator<typename storage::iterator, T>;
+    using const_iterator = element_iterator<typename storage::const_iterator, const T>;
+
+    stable_vector() = default;
+
+    stable_vector(const stable_vector &other)
+    {
+        *this = other;
+    }
+
+    stable_vector &operator=(const stable_vector &other)
+    {
+        if (this != &other)
+        {
+            elements_.clear();
+            elements_.reserve(other.elements_.size());
+
+            for (const auto &element : other.elements_)
+            {
+                elements_.emplace_back(new T(*element));
+            }
+        }
+
+        return *this;
+    }
+
+    T &operator[](std::size_t position)
+    {
+        return *elements_[position];
+    }
+
+    const T &operator[](std::size_t position) const
+    {
+        return *elements_[position];
+    }
+
+    T &back()
+    {
+        return *elements_.back();
+    }
+
+    std::size_t size() const
+    {
+        return elements_.size();
+    }
+
+    bool empty() const
+    {
+        return elements_.empty();
+    }
+
+    iterator begin()
+    {
+        return iterator(elements_.begin());
+    }
+
+    iterator end()
+    {
+        return iterator(elements_.end());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(elements_.begin());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(elements_.end());
+    }
+
+    /// <summary>
+    /// Appends a copy of value and returns it.
+    /// </summary>
+    T &push_back(const T &value)
+    {
+        elements_.emplace_back(new T(value));
+        return *elements_.back();
+    }
+
+    /// <summary>
+    /// Destroys every element for which predicate returns true in a single pass. The
+    /// remaining elements keep their order and addresses.
+    /// </summary>
+    template <typename Predicate>
+    void erase_if(Predicate predicate)
+    {
+        elements_.erase(std::remove_if(elements_.begin(), elements_.end(),
+                            [&predicate](const std::unique_ptr<T> &element) { return predicate(*element); }),
+            elements_.end());
+    }
+
+    void clear()
+    {
+        elements_.clear();
+    }
+
+private:
+    storage elements_;
+};
+
+} // namespace detail
+} // namespace xlnt
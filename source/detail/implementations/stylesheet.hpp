@@ -23,12 +23,16 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <iterator>
 #include <list>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <detail/implementations/conditional_format_impl.hpp>
 #include <detail/implementations/format_impl.hpp>
+#include <detail/implementations/stable_vector.hpp>
 #include <detail/implementations/style_impl.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/conditional_format.hpp>
@@ -42,12 +46,177 @@
 namespace xlnt {
 namespace detail {
 
+/// <summary>
+/// A hash index over a table of styling components, used to find an element equal
+/// to a given one without comparing it to every element. The index is a cache:
+/// elements are indexed the next time the table is searched, so elements that are
+/// appended and then filled in place, as the consumer does, are indexed by their
+/// final value. A copy starts out empty and indexes its own table on first use.
+/// reset must be called after elements are erased from the table or changed in place.
+/// </summary>
+template <typename T>
+class component_index
+{
+public:
+    component_index() = default;
+
+    component_index(const component_index &)
+    {
+    }
+
+    component_index &operator=(const component_index &)
+    {
+        reset();
+        return *this;
+    }
+
+    /// <summary>
+    /// Returns the position of the first element of table equal to item, or the
+    /// size of table if there is none.
+    /// </summary>
+    std::size_t find(const std::vector<T> &table, const T &item)
+    {
+        if (table.size() < indexed_)
+        {
+            reset();
+        }
+
+        for (; indexed_ < table.size(); ++indexed_)
+        {
+            positions_.emplace(std::hash<T>()(table[indexed_]), indexed_);
+        }
+
+        auto match = table.size();
+        auto candidates = positions_.equal_range(std::hash<T>()(item));
+
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if (candidate->second < match && table[candidate->second] == item)
+            {
+                match = candidate->second;
+            }
+        }
+
+        return match;
+    }
+
+    void reset()
+    {
+        positions_.clear();
+        indexed_ = 0;
+    }
+
+private:
+    std::unordered_multimap<std::size_t, std::size_t> positions_;
+
+    /// <summary>
+    /// The number of elements at the start of the table that are indexed.
+    /// </summary>
+    std::size_t indexed_ = 0;
+};
+
+/// <summary>
+/// A component_index for format_impls. Cells point to formats, so unlike other
+/// components formats are erased individually rather than the index being reset,
+/// and they are indexed by address. A format that is erased or changed in place
+/// must be passed to erase first, and a changed format that was indexed must be
+/// passed to insert afterwards.
+/// </summary>
+class format_index
+{
+public:
+    format_index() = default;
+
+    format_index(const format_index &)
+    {
+    }
+
+    format_index &operator=(const format_index &)
+    {
+        reset();
+        return *this;
+    }
+
+    /// <summary>
+    /// Returns the format in formats with the lowest id that is equal to item, or
+    /// nullptr if there is none.
+    /// </summary>
+    format_impl *find(stable_vector<format_impl> &formats, const format_impl &item)
+    {
+        if (formats.size() < indexed_)
+        {
+            reset();
+        }
+
+        while (indexed_ < formats.size())
+        {
+            insert(formats[indexed_]);
+        }
+
+        format_impl *match = nullptr;
+        auto candidates = formats_.equal_range(std::hash<format_impl>()(item));
+
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if ((match == nullptr || candidate->second->id < match->id) && *candidate->second == item)
+            {
+                match = candidate->second;
+            }
+        }
+
+        return match;
+    }
+
+    /// <summary>
+    /// Adds format, which must have been removed by erase, back to the index.
+    /// </summary>
+    void insert(format_impl &format)
+    {
+        formats_.emplace(std::hash<format_impl>()(format), &format);
+        ++indexed_;
+    }
+
+    /// <summary>
+    /// Removes format from the index and returns true if it was indexed.
+    /// </summary>
+    bool erase(const format_impl &format)
+    {
+        auto candidates = formats_.equal_range(std::hash<format_impl>()(format));
+
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if (candidate->second == &format)
+            {
+                formats_.erase(candidate);
+                --indexed_;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void reset()
+    {
+        formats_.clear();
+        indexed_ = 0;
+    }
+
+private:
+    std::unordered_multimap<std::size_t, format_impl *> formats_;
+
+    /// <summary>
+    /// The number of formats at the start of the list that are indexed.
+    /// </summary>
+    std::size_t indexed_ = 0;
+};
+
 struct stylesheet
 {
     class format create_format(bool default_format)
     {
-		format_impls.push_back(format_impl());
-		auto &impl = format_impls.back();
+		auto &impl = format_impls.push_back(format_impl());
 
 		impl.parent = this;
 		impl.id = format_impls.size() - 1;
@@ -58,16 +227,20 @@ struct stylesheet
         impl.number_format_id = 0;
         
         impl.references = default_format ? 1 : 0;
+        formats_released = formats_released || !default_format;
+        retain_components(impl);
         
         return xlnt::format(&impl);
     }
 
     class xlnt::format format(std::size_t index)
     {
-        auto iter = format_impls.begin();
-        std::advance(iter, static_cast<std::list<format_impl>::difference_type>(index));
+        if (index >= format_impls.size())
+        {
+            throw invalid_parameter();
+        }
 
-        return xlnt::format(&*iter);
+        return xlnt::format(&format_impls[index]);
     }
 
     class style create_style(const std::string &name)
@@ -81,6 +254,7 @@ struct stylesheet
         impl.fill_id = 0;
         impl.font_id = 0;
         impl.number_format_id = 0;
+        retain_components(impl);
 
         style_names.push_back(name);
         return xlnt::style(&impl);
@@ -177,242 +351,312 @@ struct stylesheet
 		return id;
 	}
     
-    template<typename T, typename C>
-    std::size_t find_or_add(C &container, const T &item, bool *added = nullptr)
+    template<typename T>
+    std::size_t find_or_add(std::vector<T> &container, component_index<T> &index, const T &item)
     {
-        if (added != nullptr)
+        auto position = index.find(container, item);
+
+        if (position == container.size())
         {
-            *added = false;
+            container.push_back(item);
         }
 
-        std::size_t i = 0;
-        
-        for (auto iter = container.begin(); iter != container.end(); ++iter)
+        return position;
+    }
+
+    /// <summary>
+    /// Changes format in place with change(format), keeping the format index up to date.
+    /// Every cell using format sees the change.
+    /// </summary>
+    template<typename Change>
+    void change_format(format_impl &format, Change change)
+    {
+        const auto indexed = format_impl_index.erase(format);
+        change(format);
+
+        if (indexed)
         {
-            if (*iter == item)
-            {
-                return i;
-            }
+            format_impl_index.insert(format);
+        }
+    }
+    
+    /// <summary>
+    /// Adds a reference to the component at id in a table with the given reference counts.
+    /// </summary>
+    void retain(std::vector<std::size_t> &references, const optional<std::size_t> &id)
+    {
+        if (!references_counted || !id.is_set()) return;
 
-            ++i;
+        if (id.get() >= references.size())
+        {
+            references.resize(id.get() + 1, 0);
         }
 
-        if (added != nullptr)
+        ++references[id.get()];
+    }
+
+    /// <summary>
+    /// Removes a reference to the component at id. The next garbage collection compacts
+    /// the component tables if this was the last one.
+    /// </summary>
+    void release(std::vector<std::size_t> &references, const optional<std::size_t> &id)
+    {
+        if (!references_counted || !id.is_set() || id.get() >= references.size()) return;
+
+        if (references[id.get()] > 0 && --references[id.get()] == 0)
         {
-            *added = true;
+            components_released = true;
         }
+    }
 
-        container.emplace(container.end(), item);
+    /// <summary>
+    /// Points id at new_id, moving its reference from the old component to the new one.
+    /// </summary>
+    void reassign(std::vector<std::size_t> &references, optional<std::size_t> &id, std::size_t new_id)
+    {
+        const auto old_id = id;
+        id = new_id;
+        retain(references, id);
+        release(references, old_id);
+    }
 
-        return container.size() - 1;
+    template<typename T>
+    void retain_components(const T &impl)
+    {
+        retain(alignment_references, impl.alignment_id);
+        retain(border_references, impl.border_id);
+        retain(fill_references, impl.fill_id);
+        retain(font_references, impl.font_id);
+        retain(protection_references, impl.protection_id);
     }
-    
+
     template<typename T>
-    std::unordered_map<std::size_t, std::size_t> garbage_collect(
-        const std::unordered_map<std::size_t, std::size_t> &reference_counts,
-        std::vector<T> &container)
+    void release_components(const T &impl)
     {
-        std::unordered_map<std::size_t, std::size_t> id_map;
-        std::size_t unreferenced = 0;
-        const auto original_size = container.size();
+        release(alignment_references, impl.alignment_id);
+        release(border_references, impl.border_id);
+        release(fill_references, impl.fill_id);
+        release(font_references, impl.font_id);
+        release(protection_references, impl.protection_id);
+    }
+
+    /// <summary>
+    /// Adds a cell's reference to format.
+    /// </summary>
+    void retain(format_impl &format)
+    {
+        ++format.references;
+    }
 
-        for (std::size_t i = 0; i < original_size; ++i)
+    /// <summary>
+    /// Removes a cell's reference to format. The next garbage collection erases the
+    /// format if this was the last one.
+    /// </summary>
+    void release(format_impl &format)
+    {
+        if (format.references > 0 && --format.references == 0)
         {
-            id_map[i] = i - unreferenced;
+            formats_released = true;
+        }
+    }
+
+    /// <summary>
+    /// Counts the references to every component from scratch. This only happens once,
+    /// the first time the garbage is collected after the stylesheet was read or cleared,
+    /// after which the counts are kept up to date as references are added and removed.
+    /// </summary>
+    void count_references()
+    {
+        alignment_references.assign(alignments.size(), 0);
+        border_references.assign(borders.size(), 0);
+        fill_references.assign(fills.size(), 0);
+        font_references.assign(fonts.size(), 0);
+        protection_references.assign(protections.size(), 0);
+
+        references_counted = true;
 
-            if (reference_counts.count(i) == 0 || reference_counts.at(i) == 0)
+        for (const auto &impl : format_impls)
+        {
+            retain_components(impl);
+            formats_released = formats_released || impl.references == 0;
+        }
+
+        for (const auto &name_impl : style_impls)
+        {
+            retain_components(name_impl.second);
+        }
+
+        for (const auto &impl : conditional_format_impls)
+        {
+            retain(border_references, impl.border_id);
+            retain(fill_references, impl.fill_id);
+            retain(font_references, impl.font_id);
+        }
+
+        components_released = true;
+    }
+
+    /// <summary>
+    /// Moves the referenced components of container to its front in one pass, keeping
+    /// the first pinned components regardless, and returns a map from each old id to its
+    /// new one. The map is empty if nothing was removed.
+    /// </summary>
+    template<typename T>
+    std::vector<std::size_t> compact(std::vector<T> &container, std::vector<std::size_t> &references,
+        component_index<T> &index, std::size_t pinned = 0)
+    {
+        references.resize(container.size(), 0);
+
+        std::vector<std::size_t> id_map(container.size(), 0);
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < container.size(); ++i)
+        {
+            if (i >= pinned && references[i] == 0) continue;
+
+            id_map[i] = kept;
+
+            if (kept != i)
             {
-                container.erase(container.begin() + static_cast<typename std::vector<T>::difference_type>(i - unreferenced));
-                unreferenced++;
+                container[kept] = std::move(container[i]);
+                references[kept] = references[i];
             }
+
+            ++kept;
         }
 
+        if (kept == container.size())
+        {
+            return {};
+        }
+
+        container.resize(kept);
+        references.resize(kept);
+        index.reset();
+
         return id_map;
     }
-    
+
+    static void remap(optional<std::size_t> &id, const std::vector<std::size_t> &id_map)
+    {
+        if (!id_map.empty() && id.is_set())
+        {
+            id = id_map[id.get()];
+        }
+    }
+
+    template<typename T>
+    void remap_components(T &impl, const std::vector<std::size_t> &alignment_id_map,
+        const std::vector<std::size_t> &border_id_map, const std::vector<std::size_t> &fill_id_map,
+        const std::vector<std::size_t> &font_id_map, const std::vector<std::size_t> &protection_id_map)
+    {
+        remap(impl.alignment_id, alignment_id_map);
+        remap(impl.border_id, border_id_map);
+        remap(impl.fill_id, fill_id_map);
+        remap(impl.font_id, font_id_map);
+        remap(impl.protection_id, protection_id_map);
+    }
+
+    /// <summary>
+    /// Erases formats no cell refers to and components nothing refers to. Reference
+    /// counts are maintained as they change, so this does nothing unless a count
+    /// dropped to zero since the last collection and is otherwise linear in the table sizes.
+    /// </summary>
     void garbage_collect()
     {
         if (!garbage_collection_enabled) return;
-        
-        auto format_iter = format_impls.begin();
 
-        while (format_iter != format_impls.end())
+        if (!references_counted)
         {
-            auto &impl = *format_iter;
+            count_references();
+        }
 
-            if (impl.references != 0)
-            {
-                ++format_iter;
-            }
-            else
+        if (formats_released)
+        {
+            formats_released = false;
+
+            format_impls.erase_if([this](const format_impl &impl) {
+                if (impl.references != 0)
+                {
+                    return false;
+                }
+
+                format_impl_index.erase(impl);
+                release_components(impl);
+
+                return true;
+            });
+
+            std::size_t new_id = 0;
+
+            for (auto &impl : format_impls)
             {
-                format_iter = format_impls.erase(format_iter);
+                impl.id = new_id++;
             }
         }
-        
-        std::size_t new_id = 0;
-
-        std::unordered_map<std::size_t, std::size_t> alignment_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> border_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> fill_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> font_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> number_format_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> protection_reference_counts;
-        
-        fill_reference_counts[0]++;
-        fill_reference_counts[1]++;
-        
-        for (auto &impl : format_impls)
+
+        if (!components_released
+            && alignment_references.size() >= alignments.size()
+            && border_references.size() >= borders.size()
+            && fill_references.size() >= fills.size()
+            && font_references.size() >= fonts.size()
+            && protection_references.size() >= protections.size())
         {
-            impl.id = new_id++;
-            
-            if (impl.alignment_id.is_set())
-            {
-                alignment_reference_counts[impl.alignment_id.get()]++;
-            }
-            
-            if (impl.border_id.is_set())
-            {
-                border_reference_counts[impl.border_id.get()]++;
-            }
-            
-            if (impl.fill_id.is_set())
-            {
-                fill_reference_counts[impl.fill_id.get()]++;
-            }
-            
-            if (impl.font_id.is_set())
-            {
-                font_reference_counts[impl.font_id.get()]++;
-            }
-            
-            if (impl.number_format_id.is_set())
-            {
-                number_format_reference_counts[impl.number_format_id.get()]++;
-            }
-            
-            if (impl.protection_id.is_set())
-            {
-                protection_reference_counts[impl.protection_id.get()]++;
-            }
+            return;
         }
-        
-        for (auto &name_impl_pair : style_impls)
+
+        components_released = false;
+
+        // the two default fills are always written, whether or not anything uses them
+        const auto alignment_id_map = compact(alignments, alignment_references, alignment_index);
+        const auto border_id_map = compact(borders, border_references, border_index);
+        const auto fill_id_map = compact(fills, fill_references, fill_index, 2);
+        const auto font_id_map = compact(fonts, font_references, font_index);
+        const auto protection_id_map = compact(protections, protection_references, protection_index);
+
+        if (alignment_id_map.empty() && border_id_map.empty() && fill_id_map.empty()
+            && font_id_map.empty() && protection_id_map.empty())
         {
-            auto &impl = name_impl_pair.second;
-            
-            if (impl.alignment_id.is_set())
-            {
-                alignment_reference_counts[impl.alignment_id.get()]++;
-            }
-            
-            if (impl.border_id.is_set())
-            {
-                border_reference_counts[impl.border_id.get()]++;
-            }
-            
-            if (impl.fill_id.is_set())
-            {
-                fill_reference_counts[impl.fill_id.get()]++;
-            }
-            
-            if (impl.font_id.is_set())
-            {
-                font_reference_counts[impl.font_id.get()]++;
-            }
-            
-            if (impl.number_format_id.is_set())
-            {
-                number_format_reference_counts[impl.number_format_id.get()]++;
-            }
-            
-            if (impl.protection_id.is_set())
-            {
-                protection_reference_counts[impl.protection_id.get()]++;
-            }
+            return;
         }
-        
-        auto alignment_id_map = garbage_collect(alignment_reference_counts, alignments);
-        auto border_id_map = garbage_collect(border_reference_counts, borders);
-        auto fill_id_map = garbage_collect(fill_reference_counts, fills);
-        auto font_id_map = garbage_collect(font_reference_counts, fonts);
-        auto protection_id_map = garbage_collect(protection_reference_counts, protections);
+
+        // erasing components changes the ids the formats refer to and so their hashes
+        format_impl_index.reset();
 
         for (auto &impl : format_impls)
         {
-            if (impl.alignment_id.is_set())
-            {
-                impl.alignment_id = alignment_id_map[impl.alignment_id.get()];
-            }
-            
-            if (impl.border_id.is_set())
-            {
-                impl.border_id = border_id_map[impl.border_id.get()];
-            }
-            
-            if (impl.fill_id.is_set())
-            {
-                impl.fill_id = fill_id_map[impl.fill_id.get()];
-            }
-            
-            if (impl.font_id.is_set())
-            {
-                impl.font_id = font_id_map[impl.font_id.get()];
-            }
-            
-            if (impl.protection_id.is_set())
-            {
-                impl.protection_id = protection_id_map[impl.protection_id.get()];
-            }
+            remap_components(impl, alignment_id_map, border_id_map, fill_id_map, font_id_map, protection_id_map);
         }
 
         for (auto &name_impl : style_impls)
         {
-            auto &impl = name_impl.second;
+            remap_components(name_impl.second, alignment_id_map, border_id_map, fill_id_map, font_id_map, protection_id_map);
+        }
 
-            if (impl.alignment_id.is_set())
-            {
-                impl.alignment_id = alignment_id_map[impl.alignment_id.get()];
-            }
-            
-            if (impl.border_id.is_set())
-            {
-                impl.border_id = border_id_map[impl.border_id.get()];
-            }
-            
-            if (impl.fill_id.is_set())
-            {
-                impl.fill_id = fill_id_map[impl.fill_id.get()];
-            }
-            
-            if (impl.font_id.is_set())
-            {
-                impl.font_id = font_id_map[impl.font_id.get()];
-            }
-            
-            if (impl.protection_id.is_set())
-            {
-                impl.protection_id = protection_id_map[impl.protection_id.get()];
-            }
+        for (auto &impl : conditional_format_impls)
+        {
+            remap(impl.border_id, border_id_map);
+            remap(impl.fill_id, fill_id_map);
+            remap(impl.font_id, font_id_map);
         }
     }
 
     format_impl *find_or_create(format_impl &pattern)
     {
-        auto iter = format_impls.begin();
-        bool added = false;
-        auto id = find_or_add(format_impls, pattern, &added);
-        std::advance(iter, static_cast<std::list<format_impl>::difference_type>(id));
-        
-        auto &result = *iter;
+        auto match = format_impl_index.find(format_impls, pattern);
 
-        if (added)
+        if (match == nullptr)
         {
-            result.references = 0;
+            match = &format_impls.push_back(pattern);
+            match->references = 0;
+            match->id = format_impls.size() - 1;
+            retain_components(*match);
         }
 
+        auto &result = *match;
+        const auto id = result.id;
+
         result.parent = this;
-        result.id = id;
         result.references++;
         
         if (id != pattern.id)
@@ -435,7 +679,7 @@ struct stylesheet
     format_impl *find_or_create_with(format_impl *pattern, const alignment &new_alignment, bool applied)
     {
         format_impl new_format = *pattern;
-        new_format.alignment_id = find_or_add(alignments, new_alignment);
+        new_format.alignment_id = find_or_add(alignments, alignment_index, new_alignment);
         new_format.alignment_applied = applied;
         
         return find_or_create(new_format);
@@ -444,7 +688,7 @@ struct stylesheet
     format_impl *find_or_create_with(format_impl *pattern, const border &new_border, bool applied)
     {
         format_impl new_format = *pattern;
-        new_format.border_id = find_or_add(borders, new_border);
+        new_format.border_id = find_or_add(borders, border_index, new_border);
         new_format.border_applied = applied;
         
         return find_or_create(new_format);
@@ -453,7 +697,7 @@ struct stylesheet
     format_impl *find_or_create_with(format_impl *pattern, const fill &new_fill, bool applied)
     {
         format_impl new_format = *pattern;
-        new_format.fill_id = find_or_add(fills, new_fill);
+        new_format.fill_id = find_or_add(fills, fill_index, new_fill);
         new_format.fill_applied = applied;
         
         return find_or_create(new_format);
@@ -462,7 +706,7 @@ struct stylesheet
     format_impl *find_or_create_with(format_impl *pattern, const font &new_font, bool applied)
     {
         format_impl new_format = *pattern;
-        new_format.font_id = find_or_add(fonts, new_font);
+        new_format.font_id = find_or_add(fonts, font_index, new_font);
         new_format.font_applied = applied;
         
         return find_or_create(new_format);
@@ -473,7 +717,7 @@ struct stylesheet
         format_impl new_format = *pattern;
         if (new_number_format.id() >= 164)
         {
-            find_or_add(number_formats, new_number_format);
+            find_or_add(number_formats, number_format_index, new_number_format);
         }
         new_format.number_format_id = new_number_format.id();
         new_format.number_format_applied = applied;
@@ -484,7 +728,7 @@ struct stylesheet
     format_impl *find_or_create_with(format_impl *pattern, const protection &new_protection, bool applied)
     {
         format_impl new_format = *pattern;
-        new_format.protection_id = find_or_add(protections, new_protection);
+        new_format.protection_id = find_or_add(protections, protection_index, new_protection);
         new_format.protection_applied = applied;
         
         return find_or_create(new_format);
@@ -510,6 +754,23 @@ struct stylesheet
         fonts.clear();
         number_formats.clear();
         protections.clear();
+
+        format_impl_index.reset();
+        alignment_index.reset();
+        border_index.reset();
+        fill_index.reset();
+        font_index.reset();
+        number_format_index.reset();
+        protection_index.reset();
+
+        alignment_references.clear();
+        border_references.clear();
+        fill_references.clear();
+        font_references.clear();
+        protection_references.clear();
+        references_counted = false;
+        formats_released = false;
+        components_released = false;
         
         colors.clear();
     }
@@ -533,7 +794,13 @@ struct stylesheet
     bool garbage_collection_enabled = true;
 
 	std::list<conditional_format_impl> conditional_format_impls;
-    std::list<format_impl> format_impls;
+
+    /// <summary>
+    /// The cell formats, where a format's id is its position. Cells point to their
+    /// format, so the formats never move.
+    /// </summary>
+    stable_vector<format_impl> format_impls;
+
     std::unordered_map<std::string, style_impl> style_impls;
     std::vector<std::string> style_names;
 
@@ -545,6 +812,31 @@ struct stylesheet
 	std::vector<protection> protections;
     
     std::vector<color> colors;
+
+    /// <summary>
+    /// Hash indices over the tables above used by find_or_create and find_or_add.
+    /// </summary>
+    format_index format_impl_index;
+    component_index<alignment> alignment_index;
+    component_index<border> border_index;
+    component_index<fill> fill_index;
+    component_index<font> font_index;
+    component_index<number_format> number_format_index;
+    component_index<protection> protection_index;
+
+    /// <summary>
+    /// The number of formats, styles and conditional formats referring to each entry of
+    /// the component tables above, valid once references_counted is set.
+    /// </summary>
+    std::vector<std::size_t> alignment_references;
+    std::vector<std::size_t> border_references;
+    std::vector<std::size_t> fill_references;
+    std::vector<std::size_t> font_references;
+    std::vector<std::size_t> protection_references;
+
+    bool references_counted = false;
+    bool formats_released = false;
+    bool components_released = false;
 };
 
 } // namespace detail
@@ -22,11 +22,14 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
+#include <iterator>
 #include <list>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <detail/implementations/shared_string_table.hpp>
 #include <detail/implementations/stylesheet.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/packaging/manifest.hpp>
@@ -62,8 +65,11 @@ struct workbook_impl
           custom_properties_(other.custom_properties_),
           view_(other.view_),
           code_name_(other.code_name_),
-          file_version_(other.file_version_)
+          file_version_(other.file_version_),
+          thread_count_(other.thread_count_),
+          compression_block_size_(other.compression_block_size_)
     {
+        index_sheets();
     }
 
     workbook_impl &operator=(const workbook_impl &other)
@@ -71,8 +77,8 @@ struct workbook_impl
         active_sheet_index_ = other.active_sheet_index_;
         worksheets_.clear();
         std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
-        shared_strings_.clear();
-        std::copy(other.shared_strings_.begin(), other.shared_strings_.end(), std::back_inserter(shared_strings_));
+        index_sheets();
+        shared_strings_ = other.shared_strings_;
 		theme_ = other.theme_;
         manifest_ = other.manifest_;
 
@@ -80,6 +86,8 @@ struct workbook_impl
 		view_ = other.view_;
 		code_name_ = other.code_name_;
 		file_version_ = other.file_version_;
+        thread_count_ = other.thread_count_;
+        compression_block_size_ = other.compression_block_size_;
 
         core_properties_ = other.core_properties_;
         extended_properties_ = other.extended_properties_;
@@ -88,10 +96,102 @@ struct workbook_impl
         return *this;
     }
 
+    /// <summary>
+    /// Returns the worksheet titled title or nullptr if there is none.
+    /// </summary>
+    worksheet_impl *find_sheet(const std::string &title) const
+    {
+        auto match = sheets_by_title_.find(title);
+
+        return match == sheets_by_title_.end() ? nullptr : match->second;
+    }
+
+    /// <summary>
+    /// Constructs a worksheet at position in the sheet order and returns it.
+    /// Appending is constant time.
+    /// </summary>
+    worksheet_impl &insert_sheet(std::size_t position, workbook *parent, std::size_t id, const std::string &title)
+    {
+        auto &sheet = *worksheets_.emplace(list_position(position), parent, id, title);
+
+        sheets_by_index_.insert(sheets_by_index_.begin() + static_cast<std::ptrdiff_t>(position), &sheet);
+        sheets_by_title_.emplace(title, &sheet);
+
+        return sheet;
+    }
+
+    /// <summary>
+    /// Moves the worksheet at position from to position to without copying it.
+    /// </summary>
+    void move_sheet(std::size_t from, std::size_t to)
+    {
+        if (from == to)
+        {
+            return;
+        }
+
+        auto sheet = sheets_by_index_[from];
+        worksheets_.splice(list_position(to < from ? to : to + 1), worksheets_, list_position(from));
+        sheets_by_index_.erase(sheets_by_index_.begin() + static_cast<std::ptrdiff_t>(from));
+        sheets_by_index_.insert(sheets_by_index_.begin() + static_cast<std::ptrdiff_t>(to), sheet);
+    }
+
+    /// <summary>
+    /// Destroys the worksheet at position.
+    /// </summary>
+    void erase_sheet(std::size_t position)
+    {
+        sheets_by_title_.erase(sheets_by_index_[position]->title_);
+        sheets_by_index_.erase(sheets_by_index_.begin() + static_cast<std::ptrdiff_t>(position));
+        worksheets_.erase(list_position(position));
+    }
+
+    /// <summary>
+    /// Changes the title of sheet, keeping the title index up to date.
+    /// </summary>
+    void rename_sheet(worksheet_impl &sheet, const std::string &title)
+    {
+        sheets_by_title_.erase(sheet.title_);
+        sheet.title_ = title;
+        sheets_by_title_.emplace(title, &sheet);
+    }
+
+    /// <summary>
+    /// Rebuilds sheets_by_index_ and sheets_by_title_ from worksheets_.
+    /// </summary>
+    void index_sheets()
+    {
+        sheets_by_index_.clear();
+        sheets_by_title_.clear();
+
+        for (auto &sheet : worksheets_)
+        {
+            sheets_by_index_.push_back(&sheet);
+            sheets_by_title_.emplace(sheet.title_, &sheet);
+        }
+    }
+
     optional<std::size_t> active_sheet_index_;
 
+    /// <summary>
+    /// The worksheets in sheet order. A list keeps each worksheet at the same
+    /// address for as long as it exists, so worksheet handles stay valid. Any
+    /// change to it should go through the methods above so that the indices
+    /// below stay consistent.
+    /// </summary>
     std::list<worksheet_impl> worksheets_;
-    std::vector<rich_text> shared_strings_;
+
+    /// <summary>
+    /// The elements of worksheets_ in the same order, for constant time positional access.
+    /// </summary>
+    std::vector<worksheet_impl *> sheets_by_index_;
+
+    /// <summary>
+    /// The elements of worksheets_ keyed by title. Titles are unique within a workbook.
+    /// </summary>
+    std::unordered_map<std::string, worksheet_impl *> sheets_by_title_;
+
+    shared_string_table shared_strings_;
 
     optional<stylesheet> stylesheet_;
 
@@ -121,6 +221,38 @@ struct workbook_impl
     
     optional<file_version_t> file_version_;
     optional<calculation_properties> calculation_properties_;
+
+    /// <summary>
+    /// The number of threads loading and saving may use, where 0 means one per hardware thread.
+    /// </summary>
+    std::size_t thread_count_ = 1;
+
+    /// <summary>
+    /// The size of the blocks parts are compressed in when saving, where 0 means a single stream.
+    /// </summary>
+    std::size_t compression_block_size_ = 0;
+
+private:
+    /// <summary>
+    /// Returns an iterator to the element of worksheets_ at position, or the end
+    /// iterator if position is the number of worksheets. Walks from whichever end
+    /// of the list is closer.
+    /// </summary>
+    std::list<worksheet_impl>::iterator list_position(std::size_t position)
+    {
+        if (position >= worksheets_.size() / 2)
+        {
+            auto iter = worksheets_.end();
+            std::advance(iter, -static_cast<std::ptrdiff_t>(worksheets_.size() - position));
+
+            return iter;
+        }
+
+        auto iter = worksheets_.begin();
+        std::advance(iter, static_cast<std::ptrdiff_t>(position));
+
+        return iter;
+    }
 };
 
 } // namespace detail
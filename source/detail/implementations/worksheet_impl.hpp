@@ -23,12 +23,19 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <detail/implementations/arena.hpp>
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/cell_store.hpp>
+#include <detail/implementations/shared_formula.hpp>
 #include <detail/implementations/table_impl.hpp>
+#include <xlnt/cell/comment.hpp>
+#include <xlnt/cell/rich_text.hpp>
+#include <xlnt/utils/exceptions.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
@@ -43,22 +50,47 @@ class workbook;
 
 namespace detail {
 
+/// <summary>
+/// A map from cell_impl::key() to a rarely set cell attribute. Its nodes are
+/// allocated from the worksheet's arena.
+/// </summary>
+template <typename T>
+using side_table = std::unordered_map<std::uint64_t, T, std::hash<std::uint64_t>,
+    std::equal_to<std::uint64_t>, arena_allocator<std::pair<const std::uint64_t, T>>>;
+
 struct worksheet_impl
 {
     worksheet_impl(workbook *parent_workbook, std::size_t id, const std::string &title)
         : parent_(parent_workbook),
           id_(id),
-          title_(title)
+          title_(title),
+          cell_map_(this),
+          formulae_(arena_allocator<char>(arena_)),
+          hyperlinks_(arena_allocator<char>(arena_)),
+          comments_(arena_allocator<char>(arena_)),
+          cell_text_(arena_allocator<char>(arena_)),
+          shared_formula_cells_(arena_allocator<char>(arena_))
     {
     }
 
     worksheet_impl(const worksheet_impl &other)
+        : cell_map_(this),
+          formulae_(arena_allocator<char>(arena_)),
+          hyperlinks_(arena_allocator<char>(arena_)),
+          comments_(arena_allocator<char>(arena_)),
+          cell_text_(arena_allocator<char>(arena_)),
+          shared_formula_cells_(arena_allocator<char>(arena_))
     {
         *this = other;
     }
 
     void operator=(const worksheet_impl &other)
     {
+        if (this == &other)
+        {
+            return;
+        }
+
         parent_ = other.parent_;
 
         id_ = other.id_;
@@ -66,13 +98,36 @@ struct worksheet_impl
         column_properties_ = other.column_properties_;
         row_properties_ = other.row_properties_;
         cell_map_ = other.cell_map_;
+        comments_ = other.comments_;
+        cell_text_ = other.cell_text_;
+        shared_formula_cells_ = other.shared_formula_cells_;
+
+        // strings are copied into this worksheet's arena so they outlive other
+        release_strings(formulae_);
+        release_strings(hyperlinks_);
+        formulae_.clear();
+        hyperlinks_.clear();
 
-        for (auto &row : cell_map_)
+        for (const auto &group : shared_formulae_)
         {
-            for (auto &cell : row.second)
-            {
-                cell.second.parent_ = this;
-            }
+            arena_.release(group.second.formula);
+        }
+
+        for (const auto &formula : other.formulae_)
+        {
+            formulae_.emplace(formula.first, arena_.store(formula.second));
+        }
+
+        for (const auto &hyperlink : other.hyperlinks_)
+        {
+            hyperlinks_.emplace(hyperlink.first, arena_.store(hyperlink.second));
+        }
+
+        shared_formulae_ = other.shared_formulae_;
+
+        for (auto &group : shared_formulae_)
+        {
+            group.second.formula = arena_.store(group.second.formula);
         }
 
         page_setup_ = other.page_setup_;
@@ -90,15 +145,159 @@ struct worksheet_impl
         tables_ = other.tables_;
     }
 
+    /// <summary>
+    /// Removes the side table entries of the cell identified by key.
+    /// </summary>
+    void erase_cell_attributes(std::uint64_t key)
+    {
+        erase_string(formulae_, key);
+        erase_string(hyperlinks_, key);
+        comments_.erase(key);
+        cell_text_.erase(key);
+        shared_formula_cells_.erase(key);
+    }
+
+    /// <summary>
+    /// Returns the formula of cell, expanding it from its shared formula group if it
+    /// has no formula of its own.
+    /// </summary>
+    std::string formula(const cell_impl &cell) const
+    {
+        auto match = formulae_.find(cell.key());
+
+        if (match != formulae_.end())
+        {
+            return match->second.str();
+        }
+
+        auto group = shared_formulae_.find(shared_formula_cells_.at(cell.key()));
+
+        if (group == shared_formulae_.end())
+        {
+            throw invalid_attribute();
+        }
+
+        const auto &master = group->second;
+
+        return translate_formula(master.formula.str(),
+            static_cast<std::int64_t>(cell.row_) - master.row,
+            static_cast<std::int64_t>(cell.column_.index) - master.column);
+    }
+
+    /// <summary>
+    /// Gives cell its own formula, dropping a leading '='. This doesn't register the
+    /// calculation chain in the manifest, which cell::formula does.
+    /// </summary>
+    void set_formula(cell_impl &cell, const std::string &formula)
+    {
+        store_string(formulae_, cell.key(), formula[0] == '=' ? formula.substr(1) : formula);
+        shared_formula_cells_.erase(cell.key());
+        cell.has_formula_ = true;
+        cell.type_ = cell_type::number;
+    }
+
+    /// <summary>
+    /// Records that cell belongs to shared formula group index. The master of the
+    /// group carries the formula text; every other member is expanded from it on demand.
+    /// </summary>
+    void add_shared_formula_cell(cell_impl &cell, std::uint32_t index, const std::string &formula)
+    {
+        if (!formula.empty())
+        {
+            auto match = shared_formulae_.find(index);
+
+            if (match != shared_formulae_.end())
+            {
+                arena_.release(match->second.formula);
+            }
+
+            shared_formulae_[index] = shared_formula{cell.row_, cell.column_.index, arena_.store(formula)};
+            return;
+        }
+
+        shared_formula_cells_[cell.key()] = index;
+        cell.has_formula_ = true;
+        cell.type_ = cell_type::number;
+    }
+
+    /// <summary>
+    /// Sets the entry at key in table, one of this worksheet's string side tables,
+    /// to a copy of value. The characters of the entry it replaces go back to the arena.
+    /// </summary>
+    void store_string(side_table<arena_string> &table, std::uint64_t key, const arena_string &value)
+    {
+        // copied first because value may be the entry being replaced
+        auto stored = arena_.store(value);
+        auto match = table.find(key);
+
+        if (match == table.end())
+        {
+            table.emplace(key, stored);
+            return;
+        }
+
+        arena_.release(match->second);
+        match->second = stored;
+    }
+
+    void store_string(side_table<arena_string> &table, std::uint64_t key, const std::string &value)
+    {
+        store_string(table, key, arena_string{value.data(), value.size()});
+    }
+
+    /// <summary>
+    /// Removes the entry at key in table, if any, and gives its characters back to the arena.
+    /// </summary>
+    void erase_string(side_table<arena_string> &table, std::uint64_t key)
+    {
+        auto match = table.find(key);
+
+        if (match != table.end())
+        {
+            arena_.release(match->second);
+            table.erase(match);
+        }
+    }
+
+    /// <summary>
+    /// Gives the characters of every entry in table back to the arena. The entries
+    /// must not be used afterwards.
+    /// </summary>
+    void release_strings(side_table<arena_string> &table)
+    {
+        for (const auto &entry : table)
+        {
+            arena_.release(entry.second);
+        }
+    }
+
     workbook *parent_;
 
+    /// <summary>
+    /// Serves the side table nodes and side table strings of this worksheet. Erased
+    /// entries are reused by the arena; everything it holds is returned to the system
+    /// at once when the worksheet is destroyed.
+    /// Cells live in an arena of cell_map_.
+    /// </summary>
+    arena arena_;
+
     std::size_t id_;
     std::string title_;
 
     std::unordered_map<column_t, column_properties> column_properties_;
     std::unordered_map<row_t, row_properties> row_properties_;
 
-    std::unordered_map<row_t, std::unordered_map<column_t, cell_impl>> cell_map_;
+    cell_store cell_map_;
+
+    // side tables for rarely set cell attributes
+    side_table<arena_string> formulae_;
+    side_table<arena_string> hyperlinks_;
+    side_table<comment> comments_;
+    side_table<rich_text> cell_text_;
+
+    // shared formulae read from a file, by group index, and the group of each non-master cell
+    std::unordered_map<std::uint32_t, shared_formula> shared_formulae_;
+    side_table<std::uint32_t> shared_formula_cells_;
 
     optional<page_setup> page_setup_;
     optional<range_reference> auto_filter_;
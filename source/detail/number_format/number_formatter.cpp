@@ -23,6 +23,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <mutex>
 
 #include <detail/default_case.hpp>
 #include <detail/number_format/number_formatter.hpp>
@@ -1068,38 +1070,78 @@ std::pair<format_locale, std::string> number_format_parser::locale_from_string(c
     throw std::runtime_error("unknown country code: " + country_code_string);
 }
 
+number_formatter::program number_formatter::compile(const std::string &format_string)
+{
+    // workbooks use a handful of distinct formats, so the cache is only bounded
+    // to keep a stream of generated format strings from growing it forever
+    static const std::size_t capacity = 4096;
+    static std::mutex mutex;
+    static auto cache = new std::unordered_map<std::string, program>();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto match = cache->find(format_string);
+
+        if (match != cache->end())
+        {
+            return match->second;
+        }
+    }
+
+    // parse outside the lock, a format string that fails to parse throws and isn't cached
+    number_format_parser parser(format_string);
+    parser.parse();
+    auto compiled = std::make_shared<const std::vector<format_code>>(parser.result());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (cache->size() >= capacity)
+    {
+        cache->clear();
+    }
+
+    return cache->emplace(format_string, compiled).first->second;
+}
+
 number_formatter::number_formatter(const std::string &format_string, xlnt::calendar calendar)
-    : parser_(format_string), calendar_(calendar)
+    : program_(compile(format_string)), format_(*program_), calendar_(calendar)
 {
-    parser_.parse();
-    format_ = parser_.result();
 }
 
 std::string number_formatter::format_number(long double number)
+{
+    std::string result;
+    format_number(number, result);
+
+    return result;
+}
+
+void number_formatter::format_number(long double number, std::string &result)
 {
     if (format_[0].has_condition)
     {
         if (format_[0].condition.satisfied_by(number))
         {
-            return format_number(format_[0], number);
+            format_number(format_[0], number, result);
         }
-
-        if (format_.size() == 1)
+        else if (format_.size() == 1)
         {
-            return std::string(11, '#');
+            result.append(11, '#');
         }
-
-        if (!format_[1].has_condition || format_[1].condition.satisfied_by(number))
+        else if (!format_[1].has_condition || format_[1].condition.satisfied_by(number))
         {
-            return format_number(format_[1], number);
+            format_number(format_[1], number, result);
         }
-
-        if (format_.size() == 2)
+        else if (format_.size() == 2)
+        {
+            result.append(11, '#');
+        }
+        else
         {
-            return std::string(11, '#');
+            format_number(format_[2], number, result);
         }
 
-        return format_number(format_[2], number);
+        return;
     }
 
     // no conditions, format based on sign:
@@ -1107,18 +1149,18 @@ std::string number_formatter::format_number(long double number)
     // 1 section, use for all
     if (format_.size() == 1)
     {
-        return format_number(format_[0], number);
+        format_number(format_[0], number, result);
     }
     // 2 sections, first for positive and zero, second for negative
     else if (format_.size() == 2)
     {
         if (number >= 0)
         {
-            return format_number(format_[0], number);
+            format_number(format_[0], number, result);
         }
         else
         {
-            return format_number(format_[1], std::fabs(number));
+            format_number(format_[1], std::fabs(number), result);
         }
     }
     // 3+ sections, first for positive, second for negative, third for zero
@@ -1126,15 +1168,15 @@ std::string number_formatter::format_number(long double number)
     {
         if (number > 0)
         {
-            return format_number(format_[0], number);
+            format_number(format_[0], number, result);
         }
         else if (number < 0)
         {
-            return format_number(format_[1], std::fabs(number));
+            format_number(format_[1], std::fabs(number), result);
         }
         else
         {
-            return format_number(format_[2], number);
+            format_number(format_[2], number, result);
         }
     }
 }
@@ -1154,14 +1196,14 @@ std::string number_formatter::format_text(const std::string &text)
     return format_text(format_[3], text);
 }
 
-std::string number_formatter::fill_placeholders(const format_placeholders &p, long double number)
+void number_formatter::fill_placeholders(const format_placeholders &p, long double number, std::string &result)
 {
-    std::string result;
+    const auto start = result.size();
 
     if (p.type == format_placeholders::placeholders_type::general
         || p.type == format_placeholders::placeholders_type::text)
     {
-        result = std::to_string(number);
+        result.append(std::to_string(number));
 
         while (result.back() == '0')
         {
@@ -1173,7 +1215,7 @@ std::string number_formatter::fill_placeholders(const format_placeholders &p, lo
             result.pop_back();
         }
 
-        return result;
+        return;
     }
 
     if (p.percentage)
@@ -1192,34 +1234,25 @@ std::string number_formatter::fill_placeholders(const format_placeholders &p, lo
         || p.type == format_placeholders::placeholders_type::integer_part
         || p.type == format_placeholders::placeholders_type::fraction_integer)
     {
-        result = std::to_string(integer_part);
+        result.append(std::to_string(integer_part));
 
-        while (result.size() < p.num_zeros)
+        if (result.size() - start < p.num_zeros)
         {
-            result = "0" + result;
+            result.insert(start, p.num_zeros - (result.size() - start), '0');
         }
 
-        while (result.size() < p.num_zeros + p.num_spaces)
+        if (result.size() - start < p.num_zeros + p.num_spaces)
         {
-            result = " " + result;
+            result.insert(start, p.num_zeros + p.num_spaces - (result.size() - start), ' ');
         }
 
         if (p.use_comma_separator)
         {
-            std::vector<char> digits(result.rbegin(), result.rend());
-            std::string temp;
-
-            for (std::size_t i = 0; i < digits.size(); i++)
+            // a separator goes before every group of three characters counted from the right
+            for (auto group = result.size(); group > start + 3; group -= 3)
             {
-                temp.push_back(digits[i]);
-
-                if (i % 3 == 2)
-                {
-                    temp.push_back(',');
-                }
+                result.insert(group - 3, 1, ',');
             }
-
-            result = std::string(temp.rbegin(), temp.rend());
         }
 
         if (p.percentage && p.type == format_placeholders::placeholders_type::integer_only)
@@ -1230,23 +1263,32 @@ std::string number_formatter::fill_placeholders(const format_placeholders &p, lo
     else if (p.type == format_placeholders::placeholders_type::fractional_part)
     {
         auto fractional_part = number - integer_part;
-        result = std::fabs(fractional_part) < std::numeric_limits<long double>::min()
-            ? std::string(".")
-            : std::to_string(fractional_part).substr(1);
 
-        while (result.back() == '0' || result.size() > (p.num_zeros + p.num_optionals + p.num_spaces + 1))
+        if (std::fabs(fractional_part) < std::numeric_limits<long double>::min())
+        {
+            result.push_back('.');
+        }
+        else
+        {
+            // to_string gives "0.xxxxxx", only the part from the point on is wanted
+            result.append(std::to_string(fractional_part), 1, std::string::npos);
+        }
+
+        const auto width = p.num_zeros + p.num_optionals + p.num_spaces + 1;
+
+        while (result.back() == '0' || result.size() - start > width)
         {
             result.pop_back();
         }
 
-        while (result.size() < p.num_zeros + 1)
+        if (result.size() - start < p.num_zeros + 1)
         {
-            result.push_back('0');
+            result.append(p.num_zeros + 1 - (result.size() - start), '0');
         }
 
-        while (result.size() < p.num_zeros + p.num_optionals + p.num_spaces + 1)
+        if (result.size() - start < width)
         {
-            result.push_back(' ');
+            result.append(width - (result.size() - start), ' ');
         }
 
         if (p.percentage)
@@ -1254,12 +1296,11 @@ std::string number_formatter::fill_placeholders(const format_placeholders &p, lo
             result.push_back('%');
         }
     }
-
-    return result;
 }
 
-std::string number_formatter::fill_scientific_placeholders(const format_placeholders &integer_part,
-    const format_placeholders &fractional_part, const format_placeholders &exponent_part, long double number)
+void number_formatter::fill_scientific_placeholders(const format_placeholders &integer_part,
+    const format_placeholders &fractional_part, const format_placeholders &exponent_part, long double number,
+    std::string &result)
 {
     std::size_t logarithm = 0;
 
@@ -1278,41 +1319,44 @@ std::string number_formatter::fill_scientific_placeholders(const format_placehol
     auto integer = static_cast<int>(number);
     auto fraction = number - integer;
 
-    std::string integer_string = std::to_string(integer);
-
     if (number == 0.L)
     {
-        integer_string = std::string(integer_part.num_zeros + integer_part.num_optionals, '0');
+        result.append(integer_part.num_zeros + integer_part.num_optionals, '0');
     }
-
-    std::string fractional_string = std::to_string(fraction).substr(1);
-
-    while (fractional_string.size() > fractional_part.num_zeros + fractional_part.num_optionals + 1)
+    else
     {
-        fractional_string.pop_back();
+        result.append(std::to_string(integer));
     }
 
-    std::string exponent_string = std::to_string(logarithm);
+    const auto fraction_start = result.size();
+    result.append(std::to_string(fraction), 1, std::string::npos);
 
-    while (exponent_string.size() < fractional_part.num_zeros)
+    if (result.size() - fraction_start > fractional_part.num_zeros + fractional_part.num_optionals + 1)
     {
-        exponent_string.insert(0, "0");
+        result.resize(fraction_start + fractional_part.num_zeros + fractional_part.num_optionals + 1);
     }
 
     if (exponent_part.type == format_placeholders::placeholders_type::scientific_exponent_plus)
     {
-        exponent_string.insert(0, "E+");
+        result.append("E+");
     }
     else
     {
-        exponent_string.insert(0, "E");
+        result.push_back('E');
     }
 
-    return integer_string + fractional_string + exponent_string;
+    const auto exponent = std::to_string(logarithm);
+
+    if (exponent.size() < fractional_part.num_zeros)
+    {
+        result.append(fractional_part.num_zeros - exponent.size(), '0');
+    }
+
+    result.append(exponent);
 }
 
-std::string number_formatter::fill_fraction_placeholders(const format_placeholders & /*numerator*/,
-    const format_placeholders &denominator, long double number, bool /*improper*/)
+void number_formatter::fill_fraction_placeholders(const format_placeholders & /*numerator*/,
+    const format_placeholders &denominator, long double number, bool /*improper*/, std::string &result)
 {
     auto fractional_part = number - static_cast<int>(number);
     auto original_fractional_part = fractional_part;
@@ -1347,10 +1391,12 @@ std::string number_formatter::fill_fraction_placeholders(const format_placeholde
     }
 
     auto numerator_rounded = static_cast<int>(std::round(original_fractional_part * best_denominator));
-    return std::to_string(numerator_rounded) + "/" + std::to_string(best_denominator);
+    result.append(std::to_string(numerator_rounded));
+    result.push_back('/');
+    result.append(std::to_string(best_denominator));
 }
 
-std::string number_formatter::format_number(const format_code &format, long double number)
+void number_formatter::format_number(const format_code &format, long double number, std::string &result)
 {
     static const std::vector<std::string> *month_names = new std::vector<std::string>{"January", "February", "March",
         "April", "May", "June", "July", "August", "September", "October", "November", "December"};
@@ -1358,16 +1404,17 @@ std::string number_formatter::format_number(const format_code &format, long doub
     static const std::vector<std::string> *day_names =
         new std::vector<std::string>{"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
 
-    std::string result;
+    const auto start = result.size();
 
     if (number < 0)
     {
-        result.push_back('-');
-
         if (format.is_datetime)
         {
-            return std::string(11, '#');
+            result.append(11, '#');
+            return;
         }
+
+        result.push_back('-');
     }
 
     number = std::fabs(number);
@@ -1436,7 +1483,7 @@ std::string number_formatter::format_number(const format_code &format, long doub
                     auto denominator = static_cast<int>(std::pow(10.0, digits));
                     auto fractional_seconds = dt.microsecond / 1.0E6L * denominator;
                     fractional_seconds = std::round(fractional_seconds) / denominator;
-                    result.append(fill_placeholders(part.placeholders, fractional_seconds));
+                    fill_placeholders(part.placeholders, fractional_seconds, result);
                     break;
                 }
 
@@ -1455,8 +1502,8 @@ std::string number_formatter::format_number(const format_code &format, long doub
                         break;
                     }
 
-                    result.append(fill_fraction_placeholders(
-                        part.placeholders, format.parts[i].placeholders, number, improper_fraction));
+                    fill_fraction_placeholders(
+                        part.placeholders, format.parts[i].placeholders, number, improper_fraction, result);
                 }
                 else if (part.placeholders.scientific
                     && part.placeholders.type == format_placeholders::placeholders_type::integer_part)
@@ -1465,11 +1512,11 @@ std::string number_formatter::format_number(const format_code &format, long doub
                     ++i;
                     auto fractional_part = format.parts[i++].placeholders;
                     auto exponent_part = format.parts[i++].placeholders;
-                    result.append(fill_scientific_placeholders(integer_part, fractional_part, exponent_part, number));
+                    fill_scientific_placeholders(integer_part, fractional_part, exponent_part, number, result);
                 }
                 else
                 {
-                    result.append(fill_placeholders(part.placeholders, number));
+                    fill_placeholders(part.placeholders, number, result);
                 }
 
                 break;
@@ -1676,17 +1723,11 @@ std::string number_formatter::format_number(const format_code &format, long doub
 
     const std::size_t width = 11;
 
-    if (fill && result.size() < width)
+    if (fill && result.size() - start < width)
     {
-        auto remaining = width - result.size();
-
-        std::string fill_string(remaining, fill_character.front());
         // TODO: A UTF-8 character could be multiple bytes
-
-        result = result.substr(0, fill_index) + fill_string + result.substr(fill_index);
+        result.insert(fill_index, width - (result.size() - start), fill_character.front());
     }
-
-    return result;
 }
 
 std::string number_formatter::format_text(const format_code &format, const std::string &text)
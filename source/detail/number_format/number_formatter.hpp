@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -351,22 +352,41 @@ private:
 class XLNT_API number_formatter
 {
 public:
+    /// <summary>
+    /// The parsed sections of a format string. These are immutable once parsed and so
+    /// are shared by every formatter using the same format string.
+    /// </summary>
+    using program = std::shared_ptr<const std::vector<format_code>>;
+
+    /// <summary>
+    /// Returns the parsed sections of format_string from a process-wide cache, parsing
+    /// and caching them if this is the first time the format string is seen. This is
+    /// safe to call from several threads at once.
+    /// </summary>
+    static program compile(const std::string &format_string);
+
     number_formatter(const std::string &format_string, xlnt::calendar calendar);
     std::string format_number(long double number);
     std::string format_text(const std::string &text);
 
+    /// <summary>
+    /// Appends number formatted to result. Everything is written straight into result,
+    /// so a caller reusing one buffer for many numbers doesn't allocate per number.
+    /// </summary>
+    void format_number(long double number, std::string &result);
+
 private:
-    std::string fill_placeholders(const format_placeholders &p, long double number);
-    std::string fill_fraction_placeholders(const format_placeholders &numerator,
-        const format_placeholders &denominator, long double number, bool improper);
-    std::string fill_scientific_placeholders(const format_placeholders &integer_part,
+    void fill_placeholders(const format_placeholders &p, long double number, std::string &result);
+    void fill_fraction_placeholders(const format_placeholders &numerator,
+        const format_placeholders &denominator, long double number, bool improper, std::string &result);
+    void fill_scientific_placeholders(const format_placeholders &integer_part,
         const format_placeholders &fractional_part, const format_placeholders &exponent_part,
-        long double number);
-    std::string format_number(const format_code &format, long double number);
+        long double number, std::string &result);
+    void format_number(const format_code &format, long double number, std::string &result);
     std::string format_text(const format_code &format, const std::string &text);
 
-    number_format_parser parser_;
-    std::vector<format_code> format_;
+    program program_;
+    const std::vector<format_code> &format_;
     xlnt::calendar calendar_;
 };
 
@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Returns thread_count, or the number of hardware threads if thread_count is 0.
+/// Never returns less than 1.
+/// </summary>
+inline std::size_t resolve_thread_count(std::size_t thread_count)
+{
+    if (thread_count == 0)
+    {
+        thread_count = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    }
+
+    return std::max(thread_count, std::size_t(1));
+}
+
+/// <summary>
+/// Calls f with every index in [0, count). The indices are split into at most
+/// thread_count contiguous runs of similar length and each run is handled by its
+/// own thread, the first one by the calling thread. Returns once every run is done.
+/// If f throws, the remaining indices of that run are skipped and the first
+/// exception is rethrown after all threads have finished.
+/// </summary>
+template <typename Function>
+void parallel_for(std::size_t count, std::size_t thread_count, Function f)
+{
+    const auto runs = std::min(resolve_thread_count(thread_count), count);
+
+    if (runs <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            f(i);
+        }
+
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(runs);
+
+    auto run = [&](std::size_t r) {
+        try
+        {
+            for (auto i = count * r / runs, last = count * (r + 1) / runs; i < last; ++i)
+            {
+                f(i);
+            }
+        }
+        catch (...)
+        {
+            errors[r] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(runs - 1);
+
+    for (std::size_t r = 1; r < runs; ++r)
+    {
+        threads.emplace_back(run, r);
+    }
+
+    run(0);
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (auto &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
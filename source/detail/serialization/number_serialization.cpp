@@ -0,0 +1,414 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+// The shortest digits are found with the Grisu2 algorithm from Florian Loitsch,
+// "Printing Floating-Point Numbers Quickly and Accurately with Integers" (PLDI 2010).
+// Grisu2 always produces digits that read back as exactly the input and almost always
+// the fewest such digits.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <detail/serialization/number_serialization.hpp>
+
+namespace {
+
+/// <summary>
+/// A floating-point number with a 64-bit significand and no implicit bit, f * 2^e.
+/// </summary>
+struct diy_fp
+{
+    std::uint64_t f;
+    int e;
+};
+
+diy_fp subtract(const diy_fp &a, const diy_fp &b)
+{
+    return {a.f - b.f, a.e};
+}
+
+/// <summary>
+/// Returns the upper 64 bits of the 128-bit product of a and b, rounded.
+/// </summary>
+diy_fp multiply(const diy_fp &a, const diy_fp &b)
+{
+    const std::uint64_t mask = 0xffffffff;
+
+    const auto a_high = a.f >> 32, a_low = a.f & mask;
+    const auto b_high = b.f >> 32, b_low = b.f & mask;
+
+    const auto high_high = a_high * b_high;
+    const auto low_high = a_low * b_high;
+    const auto high_low = a_high * b_low;
+    const auto low_low = a_low * b_low;
+
+    auto middle = (low_low >> 32) + (high_low & mask) + (low_high & mask);
+    middle += std::uint64_t(1) << 31;
+
+    return {high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32), a.e + b.e + 64};
+}
+
+diy_fp normalize(diy_fp x)
+{
+    while ((x.f & (std::uint64_t(1) << 63)) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+
+    return x;
+}
+
+const std::uint64_t hidden_bit = std::uint64_t(1) << 52;
+const std::uint64_t significand_mask = hidden_bit - 1;
+const int exponent_bias = 1023 + 52;
+
+/// <summary>
+/// Splits a positive finite value into its exact significand and exponent.
+/// </summary>
+diy_fp decompose(double value)
+{
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const auto biased_exponent = static_cast<int>(bits >> 52);
+    const auto significand = bits & significand_mask;
+
+    if (biased_exponent == 0)
+    {
+        return {significand, 1 - exponent_bias};
+    }
+
+    return {significand + hidden_bit, biased_exponent - exponent_bias};
+}
+
+/// <summary>
+/// Returns 10^-k for the k that brings a value with binary exponent e into [2^-60, 2^-32]
+/// once multiplied, and sets k.
+/// </summary>
+diy_fp cached_power(int e, int &k)
+{
+    // 10^-348, 10^-340, ..., 10^340, each rounded to a 64-bit significand
+    static const diy_fp powers[] =
+    {
+        {0xfa8fd5a0081c0288, -1220}, // 1e-348
+        {0xbaaee17fa23ebf76, -1193}, // 1e-340
+        {0x8b16fb203055ac76, -1166}, // 1e-332
+        {0xcf42894a5dce35ea, -1140}, // 1e-324
+        {0x9a6bb0aa55653b2d, -1113}, // 1e-316
+        {0xe61acf033d1a45df, -1087}, // 1e-308
+        {0xab70fe17c79ac6ca, -1060}, // 1e-300
+        {0xff77b1fcbebcdc4f, -1034}, // 1e-292
+        {0xbe5691ef416bd60c, -1007}, // 1e-284
+        {0x8dd01fad907ffc3c, -980}, // 1e-276
+        {0xd3515c2831559a83, -954}, // 1e-268
+        {0x9d71ac8fada6c9b5, -927}, // 1e-260
+        {0xea9c227723ee8bcb, -901}, // 1e-252
+        {0xaecc49914078536d, -874}, // 1e-244
+        {0x823c12795db6ce57, -847}, // 1e-236
+        {0xc21094364dfb5637, -821}, // 1e-228
+        {0x9096ea6f3848984f, -794}, // 1e-220
+        {0xd77485cb25823ac7, -768}, // 1e-212
+        {0xa086cfcd97bf97f4, -741}, // 1e-204
+        {0xef340a98172aace5, -715}, // 1e-196
+        {0xb23867fb2a35b28e, -688}, // 1e-188
+        {0x84c8d4dfd2c63f3b, -661}, // 1e-180
+        {0xc5dd44271ad3cdba, -635}, // 1e-172
+        {0x936b9fcebb25c996, -608}, // 1e-164
+        {0xdbac6c247d62a584, -582}, // 1e-156
+        {0xa3ab66580d5fdaf6, -555}, // 1e-148
+        {0xf3e2f893dec3f126, -529}, // 1e-140
+        {0xb5b5ada8aaff80b8, -502}, // 1e-132
+        {0x87625f056c7c4a8b, -475}, // 1e-124
+        {0xc9bcff6034c13053, -449}, // 1e-116
+        {0x964e858c91ba2655, -422}, // 1e-108
+        {0xdff9772470297ebd, -396}, // 1e-100
+        {0xa6dfbd9fb8e5b88f, -369}, // 1e-92
+        {0xf8a95fcf88747d94, -343}, // 1e-84
+        {0xb94470938fa89bcf, -316}, // 1e-76
+        {0x8a08f0f8bf0f156b, -289}, // 1e-68
+        {0xcdb02555653131b6, -263}, // 1e-60
+        {0x993fe2c6d07b7fac, -236}, // 1e-52
+        {0xe45c10c42a2b3b06, -210}, // 1e-44
+        {0xaa242499697392d3, -183}, // 1e-36
+        {0xfd87b5f28300ca0e, -157}, // 1e-28
+        {0xbce5086492111aeb, -130}, // 1e-20
+        {0x8cbccc096f5088cc, -103}, // 1e-12
+        {0xd1b71758e219652c, -77}, // 1e-4
+        {0x9c40000000000000, -50}, // 1e4
+        {0xe8d4a51000000000, -24}, // 1e12
+        {0xad78ebc5ac620000, 3}, // 1e20
+        {0x813f3978f8940984, 30}, // 1e28
+        {0xc097ce7bc90715b3, 56}, // 1e36
+        {0x8f7e32ce7bea5c70, 83}, // 1e44
+        {0xd5d238a4abe98068, 109}, // 1e52
+        {0x9f4f2726179a2245, 136}, // 1e60
+        {0xed63a231d4c4fb27, 162}, // 1e68
+        {0xb0de65388cc8ada8, 189}, // 1e76
+        {0x83c7088e1aab65db, 216}, // 1e84
+        {0xc45d1df942711d9a, 242}, // 1e92
+        {0x924d692ca61be758, 269}, // 1e100
+        {0xda01ee641a708dea, 295}, // 1e108
+        {0xa26da3999aef774a, 322}, // 1e116
+        {0xf209787bb47d6b85, 348}, // 1e124
+        {0xb454e4a179dd1877, 375}, // 1e132
+        {0x865b86925b9bc5c2, 402}, // 1e140
+        {0xc83553c5c8965d3d, 428}, // 1e148
+        {0x952ab45cfa97a0b3, 455}, // 1e156
+        {0xde469fbd99a05fe3, 481}, // 1e164
+        {0xa59bc234db398c25, 508}, // 1e172
+        {0xf6c69a72a3989f5c, 534}, // 1e180
+        {0xb7dcbf5354e9bece, 561}, // 1e188
+        {0x88fcf317f22241e2, 588}, // 1e196
+        {0xcc20ce9bd35c78a5, 614}, // 1e204
+        {0x98165af37b2153df, 641}, // 1e212
+        {0xe2a0b5dc971f303a, 667}, // 1e220
+        {0xa8d9d1535ce3b396, 694}, // 1e228
+        {0xfb9b7cd9a4a7443c, 720}, // 1e236
+        {0xbb764c4ca7a44410, 747}, // 1e244
+        {0x8bab8eefb6409c1a, 774}, // 1e252
+        {0xd01fef10a657842c, 800}, // 1e260
+        {0x9b10a4e5e9913129, 827}, // 1e268
+        {0xe7109bfba19c0c9d, 853}, // 1e276
+        {0xac2820d9623bf429, 880}, // 1e284
+        {0x80444b5e7aa7cf85, 907}, // 1e292
+        {0xbf21e44003acdd2d, 933}, // 1e300
+        {0x8e679c2f5e44ff8f, 960}, // 1e308
+        {0xd433179d9c8cb841, 986}, // 1e316
+        {0x9e19db92b4e31ba9, 1013}, // 1e324
+        {0xeb96bf6ebadf77d9, 1039}, // 1e332
+        {0xaf87023b9bf0ee6b, 1066}, // 1e340
+    };
+
+    const auto estimate = (-61 - e) * 0.30102999566398114 + 347;
+    auto index = static_cast<int>(estimate);
+
+    if (estimate - index > 0.0)
+    {
+        ++index;
+    }
+
+    index = (index >> 3) + 1;
+    k = -(-348 + index * 8);
+
+    return powers[index];
+}
+
+/// <summary>
+/// Nudges the last digit down while that brings the digits closer to the exact value
+/// and keeps them inside the rounding interval.
+/// </summary>
+void round_last_digit(char *digits, int length, std::uint64_t delta, std::uint64_t rest,
+    std::uint64_t ten_kappa, std::uint64_t distance)
+{
+    while (rest < distance && delta - rest >= ten_kappa
+        && (rest + ten_kappa < distance || distance - rest > rest + ten_kappa - distance))
+    {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+int count_digits(std::uint32_t n)
+{
+    auto count = 1;
+
+    while (n >= 10)
+    {
+        n /= 10;
+        ++count;
+    }
+
+    return count;
+}
+
+/// <summary>
+/// Writes the shortest digits within delta of upper to digits, adjusting the decimal
+/// exponent k to match, and returns how many were written.
+/// </summary>
+int generate_digits(const diy_fp &w, const diy_fp &upper, std::uint64_t delta, char *digits, int &k)
+{
+    static const std::uint64_t powers_of_ten[] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+        1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+        1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+        10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+
+    const diy_fp one = {std::uint64_t(1) << -upper.e, upper.e};
+    const auto distance = subtract(upper, w).f;
+
+    auto integral = static_cast<std::uint32_t>(upper.f >> -one.e);
+    auto fractional = upper.f & (one.f - 1);
+    auto kappa = count_digits(integral);
+    auto length = 0;
+
+    while (kappa > 0)
+    {
+        const auto divisor = static_cast<std::uint32_t>(powers_of_ten[kappa - 1]);
+        const auto digit = integral / divisor;
+        integral %= divisor;
+
+        if (digit != 0 || length != 0)
+        {
+            digits[length++] = static_cast<char>('0' + digit);
+        }
+
+        --kappa;
+        const auto rest = (static_cast<std::uint64_t>(integral) << -one.e) + fractional;
+
+        if (rest <= delta)
+        {
+            k += kappa;
+            round_last_digit(digits, length, delta, rest, powers_of_ten[kappa] << -one.e, distance);
+
+            return length;
+        }
+    }
+
+    while (true)
+    {
+        fractional *= 10;
+        delta *= 10;
+
+        const auto digit = static_cast<char>(fractional >> -one.e);
+
+        if (digit != 0 || length != 0)
+        {
+            digits[length++] = static_cast<char>('0' + digit);
+        }
+
+        fractional &= one.f - 1;
+        --kappa;
+
+        if (fractional < delta)
+        {
+            k += kappa;
+            const auto index = -kappa;
+            round_last_digit(digits, length, delta, fractional, one.f,
+                index < 20 ? distance * powers_of_ten[index] : 0);
+
+            return length;
+        }
+    }
+}
+
+/// <summary>
+/// Writes the shortest digits of the positive finite value to digits so that the value
+/// is digits * 10^k and returns how many were written.
+/// </summary>
+int grisu2(double value, char *digits, int &k)
+{
+    const auto v = decompose(value);
+
+    // the boundaries halfway to the neighbouring doubles, on a common exponent
+    auto upper = normalize({(v.f << 1) + 1, v.e - 1});
+    auto lower = v.f == hidden_bit ? diy_fp{(v.f << 2) - 1, v.e - 2} : diy_fp{(v.f << 1) - 1, v.e - 1};
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    const auto power = cached_power(upper.e, k);
+    const auto w = multiply(normalize(v), power);
+    auto scaled_upper = multiply(upper, power);
+    auto scaled_lower = multiply(lower, power);
+
+    // the products may be off by one unit, so stay strictly inside the interval
+    scaled_upper.f--;
+    scaled_lower.f++;
+
+    return generate_digits(w, scaled_upper, scaled_upper.f - scaled_lower.f, digits, k);
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+std::string serialize_number(double value)
+{
+    if (std::isnan(value))
+    {
+        return "nan";
+    }
+
+    std::string result;
+
+    if (std::signbit(value))
+    {
+        result.push_back('-');
+        value = -value;
+    }
+
+    if (std::isinf(value))
+    {
+        return result + "inf";
+    }
+
+    if (value == 0.0)
+    {
+        return result + "0";
+    }
+
+    char digits[20];
+    auto k = 0;
+    const auto length = grisu2(value, digits, k);
+
+    // the position of the decimal point relative to the start of the digits
+    const auto point = length + k;
+
+    if (k >= 0 && point <= 21)
+    {
+        // an integer, padded with zeros
+        result.append(digits, static_cast<std::size_t>(length));
+        result.append(static_cast<std::size_t>(k), '0');
+    }
+    else if (point > 0 && point <= 21)
+    {
+        result.append(digits, static_cast<std::size_t>(point));
+        result.push_back('.');
+        result.append(digits + point, static_cast<std::size_t>(length - point));
+    }
+    else if (point > -6 && point <= 0)
+    {
+        result.append("0.");
+        result.append(static_cast<std::size_t>(-point), '0');
+        result.append(digits, static_cast<std::size_t>(length));
+    }
+    else
+    {
+        result.push_back(digits[0]);
+
+        if (length > 1)
+        {
+            result.push_back('.');
+            result.append(digits + 1, static_cast<std::size_t>(length - 1));
+        }
+
+        result.push_back('E');
+        result.append(std::to_string(point - 1));
+    }
+
+    return result;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,245 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <detail/constants.hpp>
+#include <detail/serialization/parsing.hpp>
+
+namespace {
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/// <summary>
+/// Converts the null-terminated text with strtod. Like std::stold, throws
+/// std::invalid_argument if text doesn't start with a number.
+/// </summary>
+double checked_strtod(const char *text)
+{
+    char *end = nullptr;
+    const auto result = std::strtod(text, &end);
+
+    if (end == text)
+    {
+        throw std::invalid_argument("not a number");
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Falls back to strtod, which needs a null-terminated copy of the range.
+/// </summary>
+double parse_double_slow(const char *first, const char *last)
+{
+    const auto length = static_cast<std::size_t>(last - first);
+    char buffer[64];
+
+    if (length < sizeof(buffer))
+    {
+        std::memcpy(buffer, first, length);
+        buffer[length] = '\0';
+
+        return checked_strtod(buffer);
+    }
+
+    return checked_strtod(std::string(first, last).c_str());
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+bool parse_unsigned(const char *first, const char *last, std::uint64_t &result)
+{
+    if (first == last)
+    {
+        return false;
+    }
+
+    result = 0;
+
+    for (; first != last; ++first)
+    {
+        if (!is_digit(*first))
+        {
+            return false;
+        }
+
+        const auto digit = static_cast<std::uint64_t>(*first - '0');
+
+        if (result > (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+        {
+            return false;
+        }
+
+        result = result * 10 + digit;
+    }
+
+    return true;
+}
+
+double parse_double(const char *first, const char *last)
+{
+    // every integer up to 2^53 and every power of ten up to 10^22 is exactly a double,
+    // so the product or quotient of the two is the correctly rounded result
+    static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    auto current = first;
+    const auto negative = current != last && *current == '-';
+
+    if (current != last && (*current == '-' || *current == '+'))
+    {
+        ++current;
+    }
+
+    std::uint64_t significand = 0;
+    auto significant_digits = 0;
+    auto exponent = 0;
+    auto any_digits = false;
+
+    for (; current != last && is_digit(*current); ++current)
+    {
+        any_digits = true;
+
+        if (significand != 0 || *current != '0')
+        {
+            significand = significand * 10 + static_cast<std::uint64_t>(*current - '0');
+            ++significant_digits;
+        }
+
+        if (significant_digits > 19)
+        {
+            return parse_double_slow(first, last);
+        }
+    }
+
+    if (current != last && *current == '.')
+    {
+        for (++current; current != last && is_digit(*current); ++current)
+        {
+            any_digits = true;
+
+            if (significand != 0 || *current != '0')
+            {
+                significand = significand * 10 + static_cast<std::uint64_t>(*current - '0');
+                ++significant_digits;
+            }
+
+            --exponent;
+
+            if (significant_digits > 19)
+            {
+                return parse_double_slow(first, last);
+            }
+        }
+    }
+
+    if (!any_digits)
+    {
+        return parse_double_slow(first, last);
+    }
+
+    if (current != last && (*current == 'e' || *current == 'E'))
+    {
+        ++current;
+        const auto negative_exponent = current != last && *current == '-';
+
+        if (current != last && (*current == '-' || *current == '+'))
+        {
+            ++current;
+        }
+
+        auto explicit_exponent = 0;
+
+        if (current == last)
+        {
+            return parse_double_slow(first, last);
+        }
+
+        for (; current != last && is_digit(*current); ++current)
+        {
+            explicit_exponent = explicit_exponent * 10 + (*current - '0');
+
+            if (explicit_exponent > 1000)
+            {
+                return parse_double_slow(first, last);
+            }
+        }
+
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (current != last || exponent < -22 || exponent > 22 || significand > (std::uint64_t(1) << 53))
+    {
+        return parse_double_slow(first, last);
+    }
+
+    auto result = static_cast<double>(significand);
+    result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+
+    return negative ? -result : result;
+}
+
+bool parse_cell_reference(const char *first, const char *last, column_t::index_t &column, row_t &row)
+{
+    column = 0;
+    auto letters = 0;
+
+    for (; first != last && ((*first >= 'A' && *first <= 'Z') || (*first >= 'a' && *first <= 'z')); ++first)
+    {
+        // column names have at most three letters, as column_t::column_index_from_string requires
+        if (++letters > 3)
+        {
+            return false;
+        }
+
+        const auto letter = static_cast<column_t::index_t>((*first & ~0x20) - 'A' + 1);
+        column = column * 26 + letter;
+    }
+
+    std::uint64_t row_number = 0;
+
+    if (letters == 0 || !parse_unsigned(first, last, row_number)
+        || column < constants::min_column().index || column > constants::max_column().index
+        || row_number < constants::min_row() || row_number > constants::max_row())
+    {
+        return false;
+    }
+
+    row = static_cast<row_t>(row_number);
+
+    return true;
+}
+
+} // namespace detail
+} // namespace xlnt
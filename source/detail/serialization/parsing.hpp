@@ -0,0 +1,61 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstdint>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+// Parsers for the numbers and references that make up most of a worksheet's XML.
+// They read the characters in [first, last) directly rather than going through a
+// string stream or a temporary std::string.
+
+/// <summary>
+/// Parses a string of decimal digits into result. Returns false if the range is empty,
+/// contains anything other than digits, or the number doesn't fit in 64 bits.
+/// </summary>
+XLNT_API bool parse_unsigned(const char *first, const char *last, std::uint64_t &result);
+
+/// <summary>
+/// Parses a decimal number such as "-1.25E-3" and returns the closest double, as
+/// strtod would. Numbers whose digits fit in a double's significand and which have a
+/// small exponent, which covers most numbers in practice, are converted without strtod.
+/// Throws std::invalid_argument if the range doesn't start with a number.
+/// </summary>
+XLNT_API double parse_double(const char *first, const char *last);
+
+/// <summary>
+/// Parses a relative cell reference such as "AB12" into its column index and row.
+/// Returns false if the range isn't letters followed by digits or the reference is
+/// outside of the sheet.
+/// </summary>
+XLNT_API bool parse_cell_reference(const char *first, const char *last,
+    column_t::index_t &column, row_t &row);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,737 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cstring>
+
+#include <detail/serialization/parsing.hpp>
+#include <detail/serialization/sheet_data_scanner.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace {
+
+using xlnt::detail::text_range;
+
+bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool is_name_end(char c)
+{
+    return is_whitespace(c) || c == '/' || c == '>' || c == '=';
+}
+
+bool equals(const text_range &range, const char *text, std::size_t length)
+{
+    return static_cast<std::size_t>(range.last - range.first) == length
+        && std::memcmp(range.first, text, length) == 0;
+}
+
+template <std::size_t N>
+bool equals(const text_range &range, const char (&text)[N])
+{
+    return equals(range, text, N - 1);
+}
+
+const char *find(const char *first, const char *last, const char *text, std::size_t length)
+{
+    const auto found = std::search(first, last, text, text + length);
+    return found == last ? nullptr : found;
+}
+
+/// <summary>
+/// Appends the UTF-8 encoding of code_point to out. Returns false for code points
+/// that aren't allowed in XML 1.0.
+/// </summary>
+bool append_utf8(std::uint32_t code_point, std::string &out)
+{
+    if ((code_point < 0x20 && code_point != 0x9 && code_point != 0xA && code_point != 0xD)
+        || (code_point >= 0xD800 && code_point <= 0xDFFF)
+        || code_point == 0xFFFE || code_point == 0xFFFF || code_point > 0x10FFFF)
+    {
+        return false;
+    }
+
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Appends the value of a character reference such as "#x41" to out.
+/// </summary>
+bool append_character_reference(const char *first, const char *last, std::string &out)
+{
+    auto base = std::uint32_t(10);
+
+    if (++first != last && *first == 'x')
+    {
+        base = 16;
+        ++first;
+    }
+
+    if (first == last || last - first > 8)
+    {
+        return false;
+    }
+
+    auto code_point = std::uint32_t(0);
+
+    for (; first != last; ++first)
+    {
+        auto digit = std::uint32_t(0);
+
+        if (*first >= '0' && *first <= '9')
+        {
+            digit = static_cast<std::uint32_t>(*first - '0');
+        }
+        else if (base == 16 && *first >= 'a' && *first <= 'f')
+        {
+            digit = static_cast<std::uint32_t>(*first - 'a' + 10);
+        }
+        else if (base == 16 && *first >= 'A' && *first <= 'F')
+        {
+            digit = static_cast<std::uint32_t>(*first - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+
+        code_point = code_point * base + digit;
+    }
+
+    return append_utf8(code_point, out);
+}
+
+/// <summary>
+/// Appends the character data in [first, last) to out, replacing entity and character
+/// references and normalizing line breaks as an XML parser would. Returns false if the
+/// text contains anything else, such as an undeclared entity.
+/// </summary>
+bool append_character_data(const char *first, const char *last, std::string &out)
+{
+    while (first != last)
+    {
+        auto special = first;
+
+        while (special != last && *special != '&' && *special != '\r')
+        {
+            ++special;
+        }
+
+        out.append(first, special);
+
+        if (special == last)
+        {
+            break;
+        }
+
+        if (*special == '\r')
+        {
+            out.push_back('\n');
+            first = special + 1;
+
+            if (first != last && *first == '\n')
+            {
+                ++first;
+            }
+
+            continue;
+        }
+
+        const auto semicolon = static_cast<const char *>(
+            std::memchr(special, ';', static_cast<std::size_t>(last - special)));
+
+        if (semicolon == nullptr)
+        {
+            return false;
+        }
+
+        const auto name = text_range{special + 1, semicolon};
+
+        if (equals(name, "amp"))
+        {
+            out.push_back('&');
+        }
+        else if (equals(name, "lt"))
+        {
+            out.push_back('<');
+        }
+        else if (equals(name, "gt"))
+        {
+            out.push_back('>');
+        }
+        else if (equals(name, "quot"))
+        {
+            out.push_back('"');
+        }
+        else if (equals(name, "apos"))
+        {
+            out.push_back('\'');
+        }
+        else if (name.first == name.last || *name.first != '#'
+            || !append_character_reference(name.first, name.last, out))
+        {
+            return false;
+        }
+
+        first = semicolon + 1;
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+void cell_contents::clear()
+{
+    type.assign(1, 'n');
+    has_format = false;
+    format_id = 0;
+    has_value = false;
+    value.clear();
+    has_formula = false;
+    has_shared_formula = false;
+    shared_formula_index = 0;
+    formula.clear();
+}
+
+sheet_data_scanner::sheet_data_scanner(const char *first, const char *last)
+    : cursor_(first),
+      last_(last)
+{
+}
+
+bool sheet_data_scanner::next_row()
+{
+    while (true)
+    {
+        skip_whitespace();
+
+        if (cursor_ == last_)
+        {
+            return false;
+        }
+
+        if (*cursor_ != '<')
+        {
+            throw invalid_file("unexpected text in sheetData");
+        }
+
+        if (!skip_markup())
+        {
+            break;
+        }
+    }
+
+    text_range name;
+
+    if (!start_tag_name(name) || !equals(name, "row"))
+    {
+        throw invalid_file("expected a row in sheetData");
+    }
+
+    row_index = text_range();
+    row_height = text_range();
+    row_custom_height = text_range();
+    row_hidden = text_range();
+
+    auto empty = false;
+    const auto read = attributes([this](const text_range &attribute, const text_range &value) {
+        if (equals(attribute, "r"))
+        {
+            row_index = value;
+        }
+        else if (equals(attribute, "ht"))
+        {
+            row_height = value;
+        }
+        else if (equals(attribute, "customHeight"))
+        {
+            row_custom_height = value;
+        }
+        else if (equals(attribute, "hidden"))
+        {
+            row_hidden = value;
+        }
+    }, empty);
+
+    if (!read)
+    {
+        throw invalid_file("malformed row in sheetData");
+    }
+
+    in_row_ = !empty;
+
+    return true;
+}
+
+bool sheet_data_scanner::next_cell(cell_contents &contents)
+{
+    if (!in_row_)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        skip_whitespace();
+
+        if (cursor_ == last_ || *cursor_ != '<' || cursor_ + 1 == last_)
+        {
+            throw invalid_file("malformed row in sheetData");
+        }
+
+        if (cursor_[1] == '/')
+        {
+            if (!end_tag("row", 3))
+            {
+                throw invalid_file("malformed row in sheetData");
+            }
+
+            in_row_ = false;
+
+            return false;
+        }
+
+        if (!skip_markup())
+        {
+            break;
+        }
+    }
+
+    const auto start = cursor_;
+    fallback_ = !scan_cell(contents);
+
+    if (fallback_)
+    {
+        cursor_ = start;
+        skip_cell();
+    }
+
+    cell_element = text_range{start, cursor_};
+
+    return true;
+}
+
+bool sheet_data_scanner::needs_fallback() const
+{
+    return fallback_;
+}
+
+bool sheet_data_scanner::scan_cell(cell_contents &contents)
+{
+    text_range name;
+
+    if (!start_tag_name(name) || !equals(name, "c"))
+    {
+        return false;
+    }
+
+    contents.clear();
+    cell_reference = text_range();
+
+    text_range type;
+    text_range style;
+    auto empty = false;
+
+    const auto read = attributes([&](const text_range &attribute, const text_range &value) {
+        if (equals(attribute, "r"))
+        {
+            cell_reference = value;
+        }
+        else if (equals(attribute, "s"))
+        {
+            style = value;
+        }
+        else if (equals(attribute, "t"))
+        {
+            type = value;
+        }
+    }, empty);
+
+    if (!read)
+    {
+        return false;
+    }
+
+    if (type.present())
+    {
+        contents.type.assign(type.first, type.last);
+    }
+
+    if (style.present())
+    {
+        std::uint64_t format_id = 0;
+
+        if (!parse_unsigned(style.first, style.last, format_id))
+        {
+            return false;
+        }
+
+        contents.has_format = true;
+        contents.format_id = static_cast<std::size_t>(format_id);
+    }
+
+    while (!empty)
+    {
+        skip_whitespace();
+
+        if (cursor_ == last_ || *cursor_ != '<' || cursor_ + 1 == last_)
+        {
+            return false;
+        }
+
+        if (cursor_[1] == '/')
+        {
+            return end_tag("c", 1);
+        }
+
+        text_range child;
+
+        if (!start_tag_name(child))
+        {
+            return false;
+        }
+
+        auto child_empty = false;
+
+        if (equals(child, "v"))
+        {
+            contents.has_value = true;
+            contents.value.clear();
+
+            if (!attributes([](const text_range &, const text_range &) {}, child_empty)
+                || (!child_empty && !scan_value("v", 1, contents.value)))
+            {
+                return false;
+            }
+        }
+        else if (equals(child, "f"))
+        {
+            auto valid = true;
+
+            const auto read_formula = attributes([&](const text_range &attribute, const text_range &value) {
+                if (equals(attribute, "t"))
+                {
+                    contents.has_shared_formula = equals(value, "shared");
+                }
+                else if (equals(attribute, "si"))
+                {
+                    std::uint64_t index = 0;
+                    valid = parse_unsigned(value.first, value.last, index) && index <= 0xFFFFFFFF;
+                    contents.shared_formula_index = static_cast<std::uint32_t>(index);
+                }
+            }, child_empty);
+
+            contents.has_formula = true;
+            contents.formula.clear();
+
+            if (!read_formula || !valid || (!child_empty && !scan_value("f", 1, contents.formula)))
+            {
+                return false;
+            }
+        }
+        else if (equals(child, "is"))
+        {
+            // only plain inline strings; rich text runs are left to the XML parser
+            text_range text;
+
+            if (!attributes([](const text_range &, const text_range &) {}, child_empty) || child_empty)
+            {
+                return false;
+            }
+
+            skip_whitespace();
+            contents.has_value = true;
+            contents.value.clear();
+
+            if (!start_tag_name(text) || !equals(text, "t")
+                || !attributes([](const text_range &, const text_range &) {}, child_empty)
+                || (!child_empty && !scan_value("t", 1, contents.value)))
+            {
+                return false;
+            }
+
+            skip_whitespace();
+
+            if (!end_tag("is", 2))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool sheet_data_scanner::scan_value(const char *name, std::size_t name_length, std::string &value)
+{
+    const auto end = static_cast<const char *>(
+        std::memchr(cursor_, '<', static_cast<std::size_t>(last_ - cursor_)));
+
+    if (end == nullptr || !append_character_data(cursor_, end, value))
+    {
+        return false;
+    }
+
+    cursor_ = end;
+
+    return end_tag(name, name_length);
+}
+
+bool sheet_data_scanner::start_tag_name(text_range &name)
+{
+    if (cursor_ == last_ || *cursor_ != '<')
+    {
+        return false;
+    }
+
+    name.first = ++cursor_;
+
+    while (cursor_ != last_ && !is_name_end(*cursor_))
+    {
+        ++cursor_;
+    }
+
+    name.last = cursor_;
+
+    return name.first != name.last;
+}
+
+bool sheet_data_scanner::end_tag(const char *name, std::size_t name_length)
+{
+    if (static_cast<std::size_t>(last_ - cursor_) < name_length + 3
+        || cursor_[0] != '<' || cursor_[1] != '/'
+        || std::memcmp(cursor_ + 2, name, name_length) != 0)
+    {
+        return false;
+    }
+
+    cursor_ += name_length + 2;
+    skip_whitespace();
+
+    if (cursor_ == last_ || *cursor_ != '>')
+    {
+        return false;
+    }
+
+    ++cursor_;
+
+    return true;
+}
+
+template <typename Handler>
+bool sheet_data_scanner::attributes(Handler handle, bool &empty)
+{
+    while (true)
+    {
+        skip_whitespace();
+
+        if (cursor_ == last_)
+        {
+            return false;
+        }
+
+        if (*cursor_ == '>')
+        {
+            ++cursor_;
+            empty = false;
+
+            return true;
+        }
+
+        if (*cursor_ == '/')
+        {
+            if (++cursor_ == last_ || *cursor_ != '>')
+            {
+                return false;
+            }
+
+            ++cursor_;
+            empty = true;
+
+            return true;
+        }
+
+        const auto name_first = cursor_;
+
+        while (cursor_ != last_ && !is_name_end(*cursor_))
+        {
+            ++cursor_;
+        }
+
+        const auto name = text_range{name_first, cursor_};
+        skip_whitespace();
+
+        if (name.first == name.last || cursor_ == last_ || *cursor_ != '=')
+        {
+            return false;
+        }
+
+        ++cursor_;
+        skip_whitespace();
+
+        if (cursor_ == last_ || (*cursor_ != '"' && *cursor_ != '\''))
+        {
+            return false;
+        }
+
+        const auto quote = *cursor_++;
+        const auto value_last = static_cast<const char *>(
+            std::memchr(cursor_, quote, static_cast<std::size_t>(last_ - cursor_)));
+
+        if (value_last == nullptr)
+        {
+            return false;
+        }
+
+        handle(name, text_range{cursor_, value_last});
+        cursor_ = value_last + 1;
+    }
+}
+
+bool sheet_data_scanner::skip_markup()
+{
+    if (last_ - cursor_ >= 4 && std::memcmp(cursor_, "<!--", 4) == 0)
+    {
+        const auto end = find(cursor_ + 4, last_, "-->", 3);
+
+        if (end == nullptr)
+        {
+            throw invalid_file("unterminated comment in sheetData");
+        }
+
+        cursor_ = end + 3;
+
+        return true;
+    }
+
+    if (last_ - cursor_ >= 2 && cursor_[1] == '?')
+    {
+        const auto end = find(cursor_ + 2, last_, "?>", 2);
+
+        if (end == nullptr)
+        {
+            throw invalid_file("unterminated processing instruction in sheetData");
+        }
+
+        cursor_ = end + 2;
+
+        return true;
+    }
+
+    return false;
+}
+
+void sheet_data_scanner::skip_whitespace()
+{
+    while (cursor_ != last_ && is_whitespace(*cursor_))
+    {
+        ++cursor_;
+    }
+}
+
+void sheet_data_scanner::skip_cell()
+{
+    text_range name;
+    start_tag_name(name);
+
+    const auto tag_last = static_cast<const char *>(
+        std::memchr(cursor_, '>', static_cast<std::size_t>(last_ - cursor_)));
+
+    if (tag_last == nullptr)
+    {
+        throw invalid_file("malformed cell in sheetData");
+    }
+
+    cursor_ = tag_last + 1;
+
+    if (tag_last[-1] == '/')
+    {
+        return;
+    }
+
+    const auto end_tag_text = "</" + std::string(name.first, name.last);
+    auto end = cursor_;
+
+    while (true)
+    {
+        end = find(end, last_, end_tag_text.data(), end_tag_text.size());
+
+        if (end == nullptr)
+        {
+            throw invalid_file("unterminated cell in sheetData");
+        }
+
+        end += end_tag_text.size();
+
+        if (end != last_ && (*end == '>' || is_whitespace(*end)))
+        {
+            break;
+        }
+    }
+
+    cursor_ = end;
+    skip_whitespace();
+
+    if (cursor_ == last_ || *cursor_ != '>')
+    {
+        throw invalid_file("unterminated cell in sheetData");
+    }
+
+    ++cursor_;
+}
+
+} // namespace detail
+} // namespace xlnt
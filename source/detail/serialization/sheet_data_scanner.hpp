@@ -0,0 +1,137 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A range of characters in the text being scanned. first is null if the
+/// attribute or element it stands for wasn't present.
+/// </summary>
+struct text_range
+{
+    const char *first = nullptr;
+    const char *last = nullptr;
+
+    bool present() const
+    {
+        return first != nullptr;
+    }
+};
+
+/// <summary>
+/// The parts of a c element which are stored in its cell, apart from the reference.
+/// </summary>
+struct cell_contents
+{
+    /// <summary>
+    /// The t attribute, or "n" if it was left out.
+    /// </summary>
+    std::string type = "n";
+
+    bool has_format = false;
+    std::size_t format_id = 0;
+
+    bool has_value = false;
+    std::string value;
+
+    bool has_formula = false;
+    bool has_shared_formula = false;
+    std::uint32_t shared_formula_index = 0;
+    std::string formula;
+
+    /// <summary>
+    /// Resets everything to the state of an empty c element, keeping the
+    /// strings' capacity.
+    /// </summary>
+    void clear();
+};
+
+/// <summary>
+/// Reads the rows and cells in the content of a sheetData element straight from
+/// the worksheet's XML in memory, without building names, namespaces or attribute
+/// maps for every element. It understands the markup spreadsheet applications
+/// write for rows and cells. Cells containing anything else, such as rich inline
+/// strings, CDATA or comments, are reported with needs_fallback() so that they
+/// can be read by the general XML parser instead.
+/// </summary>
+class sheet_data_scanner
+{
+public:
+    /// <summary>
+    /// Scans the content of a sheetData element, i.e. the text between its start
+    /// and end tags, which must outlive the scanner.
+    /// </summary>
+    sheet_data_scanner(const char *first, const char *last);
+
+    /// <summary>
+    /// Moves to the next row, setting row_index, row_height, row_custom_height and
+    /// row_hidden from its attributes. Returns false at the end of sheetData.
+    /// </summary>
+    bool next_row();
+
+    /// <summary>
+    /// Moves to the next cell in the current row, setting cell_reference and
+    /// reading everything else into contents. Returns false at the end of the row.
+    /// </summary>
+    bool next_cell(cell_contents &contents);
+
+    /// <summary>
+    /// True if the current cell couldn't be scanned. Its contents are then
+    /// unspecified and the whole c element is in cell_element.
+    /// </summary>
+    bool needs_fallback() const;
+
+    text_range row_index;
+    text_range row_height;
+    text_range row_custom_height;
+    text_range row_hidden;
+
+    text_range cell_reference;
+    text_range cell_element;
+
+private:
+    bool scan_cell(cell_contents &contents);
+    bool scan_value(const char *name, std::size_t name_length, std::string &value);
+    bool start_tag_name(text_range &name);
+    bool end_tag(const char *name, std::size_t name_length);
+    template <typename Handler>
+    bool attributes(Handler handle, bool &empty);
+    bool skip_markup();
+    void skip_whitespace();
+    void skip_cell();
+
+    const char *cursor_;
+    const char *last_;
+    bool in_row_ = false;
+    bool fallback_ = false;
+};
+
+} // namespace detail
+} // namespace xlnt
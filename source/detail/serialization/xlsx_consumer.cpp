@@ -21,13 +21,17 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <atomic>
 #include <cctype>
 #include <numeric> // for std::accumulate
 
 #include <detail/constants.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
 #include <detail/implementations/workbook_impl.hpp>
+#include <detail/parallel.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
+#include <detail/serialization/parsing.hpp>
+#include <detail/serialization/sheet_data_scanner.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/serialization/zstream.hpp>
@@ -105,6 +109,86 @@ bool contains(const std::vector<T> &container, const T &element)
     return std::find(container.begin(), container.end(), element) != container.end();
 }
 
+/// <summary>
+/// Returns the non-negative integer in text, such as a style or shared string index.
+/// </summary>
+std::size_t parse_index(const std::string &text)
+{
+    std::uint64_t index = 0;
+
+    if (!xlnt::detail::parse_unsigned(text.data(), text.data() + text.size(), index))
+    {
+        throw xlnt::invalid_file("expected an index, found " + text);
+    }
+
+    return static_cast<std::size_t>(index);
+}
+
+/// <summary>
+/// Returns the number in text, read as strtod would.
+/// </summary>
+double parse_number(const std::string &text)
+{
+    return xlnt::detail::parse_double(text.data(), text.data() + text.size());
+}
+
+/// <summary>
+/// Finds the content of the sheetData element in a worksheet's XML and the worksheet's
+/// start tag. Returns false if sheetData is missing or empty, or if it isn't in the
+/// default namespace, in which case the XML parser reads it instead.
+/// </summary>
+bool find_sheet_data(const std::string &xml, std::string &root_element,
+    std::size_t &content_first, std::size_t &content_last)
+{
+    auto root_first = xml.find('<');
+
+    while (root_first != std::string::npos && root_first + 1 < xml.size()
+        && (xml[root_first + 1] == '?' || xml[root_first + 1] == '!'))
+    {
+        root_first = xml.find('<', root_first + 1);
+    }
+
+    const auto root_last = xml.find('>', root_first);
+
+    if (root_last == std::string::npos
+        || xml.compare(root_first, 10, "<worksheet") != 0
+        || !std::isspace(static_cast<unsigned char>(xml[root_first + 10]))
+        || xml[root_last - 1] == '/')
+    {
+        return false;
+    }
+
+    root_element = xml.substr(root_first, root_last - root_first + 1);
+    const auto &spreadsheetml = xlnt::constants::ns("spreadsheetml");
+
+    if (root_element.find("xmlns=\"" + spreadsheetml + "\"") == std::string::npos
+        && root_element.find("xmlns='" + spreadsheetml + "'") == std::string::npos)
+    {
+        return false;
+    }
+
+    const auto sheet_data = xml.find("<sheetData", root_last);
+
+    if (sheet_data == std::string::npos)
+    {
+        return false;
+    }
+
+    const auto start_tag_last = xml.find('>', sheet_data);
+    const auto name_end = xml[sheet_data + 10];
+
+    if (start_tag_last == std::string::npos || xml[start_tag_last - 1] == '/'
+        || (name_end != '>' && !std::isspace(static_cast<unsigned char>(name_end))))
+    {
+        return false;
+    }
+
+    content_first = start_tag_last + 1;
+    content_last = xml.find("</sheetData>", content_first);
+
+    return content_last != std::string::npos;
+}
+
 } // namespace
 
 /*
@@ -139,7 +223,19 @@ xlsx_consumer::~xlsx_consumer()
 
 void xlsx_consumer::read(std::istream &source)
 {
-    archive_.reset(new izstream(source));
+    if (resolve_thread_count(target_.thread_count()) > 1)
+    {
+        // worksheets will be read in parallel, each through its own izstream over these bytes
+        package_ = to_vector(source);
+        package_streambuf_.reset(new vector_istreambuf(package_));
+        package_stream_.reset(new std::istream(package_streambuf_.get()));
+        archive_.reset(new izstream(*package_stream_));
+    }
+    else
+    {
+        archive_.reset(new izstream(source));
+    }
+
     populate_workbook(false);
 }
 
@@ -161,7 +257,7 @@ cell xlsx_consumer::read_cell()
     if (in_element(qn("spreadsheetml", "sheetData")))
     {
         expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
-        auto row_index = parser().attribute<row_t>("r");
+        auto row_index = read_row_index();
 
         if (parser().attribute_present("ht"))
         {
@@ -191,105 +287,24 @@ cell xlsx_consumer::read_cell()
 
     expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
 
-    auto cell = streaming_ ? xlnt::cell(streaming_cell_.get())
-        : ws.cell(cell_reference(parser().attribute("r")));
-    auto reference = cell_reference(parser().attribute("r"));
-    cell.d_->parent_ = current_worksheet_;
-    cell.d_->column_ = reference.column_index();
-    cell.d_->row_ = reference.row();
-
-    auto has_type = parser().attribute_present("t");
-    auto type = has_type ? parser().attribute("t") : "n";
-
-    auto has_format = parser().attribute_present("s");
-    auto format_id = static_cast<std::size_t>(has_format ? std::stoull(parser().attribute("s")) : 0LL);
-
-    auto has_value = false;
-    auto value_string = std::string();
-
-    auto has_formula = false;
-    auto has_shared_formula = false;
-    auto formula_value_string = std::string();
-
-    while (in_element(qn("spreadsheetml", "c")))
+    if (streaming_)
     {
-        auto current_element = expect_start_element(xml::content::mixed);
-
-        if (current_element == qn("spreadsheetml", "v")) // s:ST_Xstring
+        // the streaming cell is reused, so drop whatever the previous cell left behind
+        if (streaming_cell_->parent_ != nullptr)
         {
-            has_value = true;
-            value_string = read_text();
+            streaming_cell_->parent_->erase_cell_attributes(streaming_cell_->key());
         }
-        else if (current_element == qn("spreadsheetml", "f")) // CT_CellFormula
-        {
-            has_formula = true;
 
-            if (parser().attribute_present("t"))
-            {
-                has_shared_formula = parser().attribute("t") == "shared";
-            }
-
-            skip_attributes(
-            { "aca", "ref", "dt2D", "dtr", "del1", "del2", "r1", "r2", "ca", "si", "bx" });
-
-            formula_value_string = read_text();
-        }
-        else if (current_element == qn("spreadsheetml", "is")) // CT_Rst
-        {
-            expect_start_element(qn("spreadsheetml", "t"), xml::content::simple);
-            value_string = read_text();
-            expect_end_element(qn("spreadsheetml", "t"));
-        }
-        else
-        {
-            unexpected_element(current_element);
-        }
-
-        expect_end_element(current_element);
+        *streaming_cell_ = detail::cell_impl();
     }
 
-    expect_end_element(qn("spreadsheetml", "c"));
-
-    if (has_formula && !has_shared_formula)
-    {
-        cell.formula(formula_value_string);
-    }
-
-    if (has_value)
-    {
-        if (type == "str")
-        {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::formula_string);
-        }
-        else if (type == "inlineStr")
-        {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::inline_string);
-        }
-        else if (type == "s")
-        {
-            cell.d_->value_numeric_ = std::stold(value_string);
-            cell.data_type(cell::type::shared_string);
-        }
-        else if (type == "b") // boolean
-        {
-            cell.value(is_true(value_string));
-        }
-        else if (type == "n") // numeric
-        {
-            cell.value(std::stold(value_string));
-        }
-        else if (!value_string.empty() && value_string[0] == '#')
-        {
-            cell.error(value_string);
-        }
-    }
+    const auto reference = read_cell_reference();
+    auto cell = streaming_ ? xlnt::cell(streaming_cell_.get()) : ws.cell(reference);
+    cell.d_->parent_ = current_worksheet_;
+    cell.d_->column_ = reference.column_index();
+    cell.d_->row_ = reference.row();
 
-    if (has_format)
-    {
-        cell.format(target_.format(format_id));
-    }
+    read_cell_contents(cell);
 
     if (!in_element(qn("spreadsheetml", "row")))
     {
@@ -317,6 +332,9 @@ void xlsx_consumer::read_worksheet(const std::string &rel_id)
 
 std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
 {
+    last_row_ = 0;
+    last_column_ = 0;
+
     if (streaming_ && streaming_cell_ == nullptr)
     {
         streaming_cell_.reset(new detail::cell_impl());
@@ -550,7 +568,7 @@ void xlsx_consumer::read_worksheet_sheetdata()
     while (in_element(qn("spreadsheetml", "sheetData")))
     {
         expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
-        auto row_index = parser().attribute<row_t>("r");
+        auto row_index = read_row_index();
 
         if (parser().attribute_present("ht"))
         {
@@ -575,106 +593,328 @@ void xlsx_consumer::read_worksheet_sheetdata()
         while (in_element(qn("spreadsheetml", "row")))
         {
             expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
-            auto cell = ws.cell(cell_reference(parser().attribute("r")));
+            read_cell_contents(ws.cell(read_cell_reference()));
+        }
 
-            auto has_type = parser().attribute_present("t");
-            auto type = has_type ? parser().attribute("t") : "n";
+        expect_end_element(qn("spreadsheetml", "row"));
+    }
 
-            auto has_format = parser().attribute_present("s");
-            auto format_id = static_cast<std::size_t>(has_format ? std::stoull(parser().attribute("s")) : 0LL);
+    expect_end_element(qn("spreadsheetml", "sheetData"));
 
-            auto has_value = false;
-            auto value_string = std::string();
+    // cells of a shared formula group whose master never appeared have nothing to expand
+    auto &members = current_worksheet_->shared_formula_cells_;
 
-            auto has_formula = false;
-            auto has_shared_formula = false;
-            auto formula_value_string = std::string();
+    for (auto member = members.begin(); member != members.end();)
+    {
+        if (current_worksheet_->shared_formulae_.count(member->second) != 0)
+        {
+            ++member;
+            continue;
+        }
 
-            while (in_element(qn("spreadsheetml", "c")))
-            {
-                auto current_element = expect_start_element(xml::content::mixed);
+        auto orphan = current_worksheet_->cell_map_.find(
+            static_cast<row_t>(member->first >> 32), static_cast<column_t::index_t>(member->first));
+        orphan->has_formula_ = false;
+        member = members.erase(member);
+    }
+}
 
-                if (current_element == qn("spreadsheetml", "v")) // s:ST_Xstring
-                {
-                    has_value = true;
-                    value_string = read_text();
-                }
-                else if (current_element == qn("spreadsheetml", "f")) // CT_CellFormula
-                {
-                    has_formula = true;
+void xlsx_consumer::read_worksheet(const std::string &rel_id, const path &part)
+{
+    auto xml = archive_->read(part);
+    auto root_element = std::string();
+    auto content_first = std::size_t(0);
+    auto content_last = std::size_t(0);
 
-                    if (parser().attribute_present("t"))
-                    {
-                        has_shared_formula = parser().attribute("t") == "shared";
-                    }
+    if (find_sheet_data(xml, root_element, content_first, content_last))
+    {
+        scan_worksheet_sheetdata(xml.data() + content_first, xml.data() + content_last, root_element);
 
-                    skip_attributes(
-                    { "aca", "ref", "dt2D", "dtr", "del1", "del2", "r1", "r2", "ca", "si", "bx" });
+        // leave the XML parser an empty sheetData element
+        xml.erase(content_first, content_last - content_first);
+    }
 
-                    formula_value_string = read_text();
-                }
-                else if (current_element == qn("spreadsheetml", "is")) // CT_Rst
-                {
-                    expect_start_element(qn("spreadsheetml", "t"), xml::content::simple);
-                    value_string = read_text();
-                    expect_end_element(qn("spreadsheetml", "t"));
-                }
-                else
-                {
-                    unexpected_element(current_element);
-                }
+    xml::parser parser(xml.data(), xml.size(), part.string());
+    parser_ = &parser;
 
-                expect_end_element(current_element);
+    read_worksheet(rel_id);
+}
+
+void xlsx_consumer::scan_worksheet_sheetdata(const char *first, const char *last, const std::string &root_element)
+{
+    auto ws = worksheet(current_worksheet_);
+    sheet_data_scanner scanner(first, last);
+    cell_contents contents;
+
+    last_row_ = 0;
+    last_column_ = 0;
+
+    while (scanner.next_row())
+    {
+        const auto row_index = read_row_index(scanner.row_index);
+
+        if (scanner.row_height.present())
+        {
+            ws.row_properties(row_index).height = parse_double(scanner.row_height.first, scanner.row_height.last);
+        }
+
+        if (scanner.row_custom_height.present())
+        {
+            ws.row_properties(row_index).custom_height = is_true(
+                std::string(scanner.row_custom_height.first, scanner.row_custom_height.last));
+        }
+
+        if (scanner.row_hidden.present() && is_true(std::string(scanner.row_hidden.first, scanner.row_hidden.last)))
+        {
+            ws.row_properties(row_index).hidden = true;
+        }
+
+        while (scanner.next_cell(contents))
+        {
+            if (scanner.needs_fallback())
+            {
+                read_cell_element(scanner.cell_element, root_element);
+                continue;
             }
 
-            expect_end_element(qn("spreadsheetml", "c"));
+            store_cell(ws.cell(read_cell_reference(scanner.cell_reference)), contents);
+        }
+    }
+}
+
+void xlsx_consumer::read_cell_element(const text_range &element, const std::string &root_element)
+{
+    // surround the cell with its ancestors so that it's parsed with the same namespaces
+    const auto xml = root_element + "<sheetData><row>" + std::string(element.first, element.last)
+        + "</row></sheetData></worksheet>";
+
+    xml::parser parser(xml.data(), xml.size(), "sheetData");
+    parser_ = &parser;
+
+    expect_start_element(qn("spreadsheetml", "worksheet"), xml::content::complex);
+    skip_attributes({ qn("mc", "Ignorable") });
+    read_namespaces();
+    expect_start_element(qn("spreadsheetml", "sheetData"), xml::content::complex);
+    expect_start_element(qn("spreadsheetml", "row"), xml::content::complex);
+    expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
+
+    read_cell_contents(worksheet(current_worksheet_).cell(read_cell_reference()));
+
+    expect_end_element(qn("spreadsheetml", "row"));
+    expect_end_element(qn("spreadsheetml", "sheetData"));
+    expect_end_element(qn("spreadsheetml", "worksheet"));
+
+    parser_ = nullptr;
+}
+
+void xlsx_consumer::read_cell_contents(cell cell)
+{
+    cell_contents contents;
+    optional<rich_text> inline_string;
 
-            if (has_formula && !has_shared_formula)
+    if (parser().attribute_present("t"))
+    {
+        contents.type = parser().attribute("t");
+    }
+
+    if (parser().attribute_present("s"))
+    {
+        contents.has_format = true;
+        contents.format_id = parse_index(parser().attribute("s"));
+    }
+
+    while (in_element(qn("spreadsheetml", "c")))
+    {
+        auto current_element = expect_start_element(xml::content::mixed);
+
+        if (current_element == qn("spreadsheetml", "v")) // s:ST_Xstring
+        {
+            contents.has_value = true;
+            contents.value = read_text();
+        }
+        else if (current_element == qn("spreadsheetml", "f")) // CT_CellFormula
+        {
+            contents.has_formula = true;
+
+            if (parser().attribute_present("t"))
             {
-                cell.formula(formula_value_string);
+                contents.has_shared_formula = parser().attribute("t") == "shared";
             }
 
-            if (has_value)
+            if (parser().attribute_present("si"))
             {
-                if (type == "str")
-                {
-                    cell.d_->value_text_ = value_string;
-                    cell.data_type(cell::type::formula_string);
-                }
-                else if (type == "inlineStr")
-                {
-                    cell.d_->value_text_ = value_string;
-                    cell.data_type(cell::type::inline_string);
-                }
-                else if (type == "s")
-                {
-                    cell.d_->value_numeric_ = std::stold(value_string);
-                    cell.data_type(cell::type::shared_string);
-                }
-                else if (type == "b") // boolean
-                {
-                    cell.value(is_true(value_string));
-                }
-                else if (type == "n") // numeric
-                {
-                    cell.value(std::stold(value_string));
-                }
-                else if (!value_string.empty() && value_string[0] == '#')
-                {
-                    cell.error(value_string);
-                }
+                contents.shared_formula_index = parser().attribute<std::uint32_t>("si");
+            }
+
+            skip_attributes(
+            { "aca", "ref", "dt2D", "dtr", "del1", "del2", "r1", "r2", "ca", "bx" });
+
+            contents.formula = read_text();
+        }
+        else if (current_element == qn("spreadsheetml", "is")) // CT_Rst
+        {
+            inline_string = read_rich_text(qn("spreadsheetml", "is"));
+            contents.has_value = true;
+            contents.value = inline_string.get().plain_text();
+        }
+        else
+        {
+            unexpected_element(current_element);
+        }
+
+        expect_end_element(current_element);
+    }
+
+    expect_end_element(qn("spreadsheetml", "c"));
+
+    store_cell(cell, contents);
+
+    if (inline_string.is_set() && contents.type == "inlineStr")
+    {
+        // store_cell only has the plain text, so the runs of a rich inline string are put back
+        current_worksheet_->cell_text_[cell.d_->key()] = inline_string.get();
+    }
+}
+
+void xlsx_consumer::store_cell(cell cell, const cell_contents &contents)
+{
+    if (contents.has_formula && !contents.formula.empty())
+    {
+        if (worker_)
+        {
+            current_worksheet_->set_formula(*cell.d_, contents.formula);
+            has_formulae_ = true;
+        }
+        else
+        {
+            cell.formula(contents.formula);
+        }
+    }
+
+    if (contents.has_shared_formula)
+    {
+        current_worksheet_->add_shared_formula_cell(*cell.d_, contents.shared_formula_index, contents.formula);
+    }
+
+    if (contents.has_value)
+    {
+        const auto &type = contents.type;
+        const auto &value = contents.value;
+
+        if (type == "str")
+        {
+            current_worksheet_->cell_text_[cell.d_->key()] = value;
+            cell.data_type(cell::type::formula_string);
+        }
+        else if (type == "inlineStr")
+        {
+            current_worksheet_->cell_text_[cell.d_->key()] = value;
+            cell.data_type(cell::type::inline_string);
+        }
+        else if (type == "s")
+        {
+            cell.d_->value_numeric_ = parse_number(value);
+            cell.data_type(cell::type::shared_string);
+        }
+        else if (type == "b") // boolean
+        {
+            cell.value(is_true(value));
+        }
+        else if (type == "n") // numeric
+        {
+            cell.value(parse_number(value));
+        }
+        else if (!value.empty() && value[0] == '#')
+        {
+            cell.error(value);
+        }
+    }
+
+    if (contents.has_format)
+    {
+        if (worker_)
+        {
+            auto &formats = target_.d_->stylesheet_.get().format_impls;
+
+            if (contents.format_id >= formats.size())
+            {
+                throw invalid_parameter();
             }
 
-            if (has_format)
+            if (contents.format_id >= format_references_.size())
             {
-                cell.format(target_.format(format_id));
+                format_references_.resize(contents.format_id + 1, 0);
             }
+
+            ++format_references_[contents.format_id];
+            cell.d_->format_ = &formats[contents.format_id];
+        }
+        else
+        {
+            cell.format(target_.format(contents.format_id));
         }
+    }
+}
 
-        expect_end_element(qn("spreadsheetml", "row"));
+row_t xlsx_consumer::read_row_index()
+{
+    if (parser().attribute_present("r"))
+    {
+        const auto &text = parser().attribute("r");
+        return read_row_index(text_range{text.data(), text.data() + text.size()});
     }
 
-    expect_end_element(qn("spreadsheetml", "sheetData"));
+    return read_row_index(text_range());
+}
+
+row_t xlsx_consumer::read_row_index(const text_range &text)
+{
+    if (text.present())
+    {
+        std::uint64_t index = 0;
+
+        if (!parse_unsigned(text.first, text.last, index)
+            || index == 0 || index > constants::max_row())
+        {
+            throw invalid_file("invalid row index " + std::string(text.first, text.last));
+        }
+
+        last_row_ = static_cast<row_t>(index);
+    }
+    else
+    {
+        ++last_row_;
+    }
+
+    last_column_ = 0;
+
+    return last_row_;
+}
+
+cell_reference xlsx_consumer::read_cell_reference()
+{
+    if (parser().attribute_present("r"))
+    {
+        const auto &text = parser().attribute("r");
+        return read_cell_reference(text_range{text.data(), text.data() + text.size()});
+    }
+
+    return read_cell_reference(text_range());
+}
+
+cell_reference xlsx_consumer::read_cell_reference(const text_range &text)
+{
+    auto column = last_column_ + 1;
+    auto row = last_row_;
+
+    if (text.present() && !parse_cell_reference(text.first, text.last, column, row))
+    {
+        throw invalid_cell_reference(std::string(text.first, text.last));
+    }
+
+    last_column_ = column;
+
+    return cell_reference(column, row);
 }
 
 worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
@@ -987,6 +1227,25 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 
     expect_end_element(qn("spreadsheetml", "worksheet"));
 
+    // comments register themselves in the manifest, which workers must leave alone
+    if (!worker_)
+    {
+        read_worksheet_comments(rel_id);
+    }
+
+    return ws;
+}
+
+void xlsx_consumer::read_worksheet_comments(const std::string &rel_id)
+{
+    auto &manifest = target_.manifest();
+
+    const auto workbook_rel = manifest.relationship(path("/"), relationship_type::office_document);
+    const auto sheet_rel = manifest.relationship(workbook_rel.target().path(), rel_id);
+    path sheet_path(sheet_rel.source().path().parent().append(sheet_rel.target().path()));
+
+    auto ws = worksheet(current_worksheet_);
+
     if (manifest.has_relationship(sheet_path, xlnt::relationship_type::comments))
     {
         auto comments_part = manifest.canonicalize({ workbook_rel, sheet_rel,
@@ -1013,8 +1272,6 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
             read_vml_drawings(ws);
         }
     }
-
-    return ws;
 }
 
 xml::parser &xlsx_consumer::parser()
@@ -1074,6 +1331,15 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
 {
     const auto &manifest = target_.manifest();
     const auto part_path = manifest.canonicalize(rel_chain);
+
+    if (rel_chain.back().type() == relationship_type::worksheet)
+    {
+        read_worksheet(rel_chain.back().id(), part_path);
+        parser_ = nullptr;
+
+        return;
+    }
+
     auto part_streambuf = archive_->open(part_path);
     std::istream part_stream(part_streambuf.get());
     xml::parser parser(part_stream, part_path.string());
@@ -1142,7 +1408,6 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
         break;
 
     case relationship_type::worksheet:
-        read_worksheet(rel_chain.back().id());
         break;
 
     case relationship_type::thumbnail:
@@ -1562,30 +1827,91 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
                 relationship_type::theme)});
     }
 
+    std::unordered_map<std::string, std::string> rel_id_title_map;
+    std::vector<std::pair<relationship, worksheet_impl *>> worksheets;
+
+    for (const auto &title_rel_id : target_.d_->sheet_title_rel_id_map_)
+    {
+        rel_id_title_map.emplace(title_rel_id.second, title_rel_id.first);
+    }
+
     for (auto worksheet_rel : manifest().relationships(workbook_path, relationship_type::worksheet))
     {
-        auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
-            target_.d_->sheet_title_rel_id_map_.end(),
-            [&](const std::pair<std::string, std::string> &p) {
-                return p.second == worksheet_rel.id();
-            })->first;
+        const auto &title = rel_id_title_map.at(worksheet_rel.id());
 
         auto id = sheet_title_id_map_[title];
         auto index = sheet_title_index_map_[title];
 
-        auto insertion_iter = target_.d_->worksheets_.begin();
-        while (insertion_iter != target_.d_->worksheets_.end() && sheet_title_index_map_[insertion_iter->title_] < index)
+        // relationships are usually listed in sheet order, so search from the back
+        const auto &sheets = target_.d_->sheets_by_index_;
+        auto position = sheets.size();
+
+        while (position > 0 && sheet_title_index_map_[sheets[position - 1]->title_] > index)
         {
-            ++insertion_iter;
+            --position;
         }
 
-        current_worksheet_ = &*target_.d_->worksheets_.emplace(insertion_iter, &target_, id, title);
+        current_worksheet_ = &target_.d_->insert_sheet(position, &target_, id, title);
 
-        if (!streaming_)
+        if (!package_.empty())
+        {
+            worksheets.emplace_back(worksheet_rel, current_worksheet_);
+        }
+        else if (!streaming_)
         {
             read_part({ workbook_rel, worksheet_rel });
         }
     }
+
+    if (!worksheets.empty())
+    {
+        read_worksheets(workbook_rel, worksheets, resolve_thread_count(target_.thread_count()));
+    }
+}
+
+void xlsx_consumer::read_worksheets(const relationship &workbook_rel,
+    const std::vector<std::pair<relationship, worksheet_impl *>> &worksheets,
+    std::size_t thread_count)
+{
+    std::vector<std::unique_ptr<xlsx_consumer>> workers(worksheets.size());
+    std::atomic<std::size_t> next(0);
+
+    // each thread takes the next unread worksheet, so one large worksheet doesn't hold up the rest
+    parallel_for(thread_count, thread_count, [&](std::size_t) {
+        for (auto i = next++; i < worksheets.size(); i = next++)
+        {
+            workers[i].reset(new xlsx_consumer(target_));
+            auto &worker = *workers[i];
+            worker.package_streambuf_.reset(new vector_istreambuf(package_));
+            worker.package_stream_.reset(new std::istream(worker.package_streambuf_.get()));
+            worker.archive_.reset(new izstream(*worker.package_stream_));
+            worker.worker_ = true;
+            worker.current_worksheet_ = worksheets[i].second;
+            worker.read_part({ workbook_rel, worksheets[i].first });
+        }
+    });
+
+    auto has_formulae = false;
+
+    for (std::size_t i = 0; i < worksheets.size(); ++i)
+    {
+        const auto &worker = *workers[i];
+
+        for (std::size_t id = 0; id < worker.format_references_.size(); ++id)
+        {
+            target_.d_->stylesheet_.get().format_impls[id].references += worker.format_references_[id];
+        }
+
+        has_formulae = has_formulae || worker.has_formulae_;
+
+        current_worksheet_ = worksheets[i].second;
+        read_worksheet_comments(worksheets[i].first.id());
+    }
+
+    if (has_formulae)
+    {
+        target_.register_workbook_part(relationship_type::calculation_chain);
+    }
 }
 
 // Write Workbook Relationship Target Parts
@@ -1636,18 +1962,20 @@ void xlsx_consumer::read_shared_string_table()
         unique_count = parser().attribute<std::size_t>("uniqueCount");
     }
 
-    auto &strings = target_.shared_strings();
+    std::size_t count = 0;
 
     while (in_element(qn("spreadsheetml", "sst")))
     {
         expect_start_element(qn("spreadsheetml", "si"), xml::content::complex);
-        strings.push_back(read_rich_text(qn("spreadsheetml", "si")));
+        // duplicates are kept so that the indices used by cells stay valid
+        target_.add_shared_string(read_rich_text(qn("spreadsheetml", "si")), true);
         expect_end_element(qn("spreadsheetml", "si"));
+        ++count;
     }
 
     expect_end_element(qn("spreadsheetml", "sst"));
 
-    if (has_unique_count && unique_count != strings.size())
+    if (has_unique_count && unique_count != count)
     {
         throw invalid_file("sizes don't match");
     }
@@ -30,14 +30,17 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <detail/external/include_libstudxml.hpp>
 #include <detail/serialization/zstream.hpp>
+#include <xlnt/cell/index_types.hpp>
 
 namespace xlnt {
 
 class cell;
+class cell_reference;
 class color;
 class rich_text;
 class manifest;
@@ -53,7 +56,9 @@ class worksheet;
 namespace detail {
 
 class izstream;
+struct cell_contents;
 struct cell_impl;
+struct text_range;
 struct worksheet_impl;
 
 /// <summary>
@@ -202,6 +207,12 @@ private:
 	/// </summary>
 	void read_worksheet(const std::string &rel_id);
 
+    /// <summary>
+    /// xl/sheets/*.xml, read into memory so that the content of sheetData can be
+    /// scanned directly instead of going through the XML parser.
+    /// </summary>
+    void read_worksheet(const std::string &rel_id, const path &part);
+
     /// <summary>
     /// xl/sheets/*.xml
     /// </summary>
@@ -217,6 +228,68 @@ private:
     /// </summary>
     worksheet read_worksheet_end(const std::string &rel_id);
 
+    /// <summary>
+    /// Reads the comments part of the current worksheet, if it has one.
+    /// </summary>
+    void read_worksheet_comments(const std::string &rel_id);
+
+    /// <summary>
+    /// Reads worksheets, which have already been added to the workbook, on up to
+    /// thread_count threads. Each worksheet is read by its own worker consumer with its
+    /// own izstream over package_ and its own parser. The changes the workers leave to
+    /// this consumer are applied once they have all finished.
+    /// </summary>
+    void read_worksheets(const relationship &workbook_rel,
+        const std::vector<std::pair<relationship, worksheet_impl *>> &worksheets,
+        std::size_t thread_count);
+
+    /// <summary>
+    /// Reads the rows and cells in [first, last), the content of a worksheet's sheetData
+    /// element, with a sheet_data_scanner. root_element is the worksheet's start tag,
+    /// which declares the namespaces needed to parse cells the scanner can't read.
+    /// </summary>
+    void scan_worksheet_sheetdata(const char *first, const char *last, const std::string &root_element);
+
+    /// <summary>
+    /// Reads a single c element with the XML parser, for cells the sheetData scanner
+    /// doesn't understand.
+    /// </summary>
+    void read_cell_element(const text_range &element, const std::string &root_element);
+
+    /// <summary>
+    /// Reads the attributes and children of the current c element, whose start tag has
+    /// just been read, into cell.
+    /// </summary>
+    void read_cell_contents(cell cell);
+
+    /// <summary>
+    /// Stores the type, value, formula and format read from a c element in cell.
+    /// </summary>
+    void store_cell(cell cell, const cell_contents &contents);
+
+    /// <summary>
+    /// Reads the r attribute of the current row, or takes the row after the previous one
+    /// if it is left out.
+    /// </summary>
+    row_t read_row_index();
+
+    /// <summary>
+    /// Takes the row index from text, or the row after the previous one if text isn't present.
+    /// </summary>
+    row_t read_row_index(const text_range &text);
+
+    /// <summary>
+    /// Reads the r attribute of the current cell, or takes the cell after the previous one
+    /// in the row if it is left out.
+    /// </summary>
+    cell_reference read_cell_reference();
+
+    /// <summary>
+    /// Takes the cell reference from text, or the cell after the previous one in the row
+    /// if text isn't present.
+    /// </summary>
+    cell_reference read_cell_reference(const text_range &text);
+
 	// Sheet Relationship Target Parts
 
 	/// <summary>
@@ -412,8 +485,34 @@ private:
 
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
+    /// <summary>
+    /// The whole package, kept in memory when worksheets are read in parallel, and the
+    /// stream over it which archive_ reads.
+    /// </summary>
+    std::vector<std::uint8_t> package_;
+    std::unique_ptr<std::streambuf> package_streambuf_;
+    std::unique_ptr<std::istream> package_stream_;
+
+    /// <summary>
+    /// True for a consumer reading a single worksheet on a worker thread. Such a consumer
+    /// doesn't touch anything shared with other worksheets. It counts the references to
+    /// each format id in format_references_ and notes in has_formulae_ whether the
+    /// calculation chain needs registering, and it leaves comments, which register
+    /// themselves in the manifest, to the consumer that started it.
+    /// </summary>
+    bool worker_ = false;
+    std::vector<std::size_t> format_references_;
+    bool has_formulae_ = false;
+
     detail::cell_impl *current_cell_;
 
+    /// <summary>
+    /// The position of the last row and cell read from sheetData, from which a row or
+    /// cell without an r attribute takes its position.
+    /// </summary>
+    row_t last_row_ = 0;
+    column_t::index_t last_column_ = 0;
+
     detail::worksheet_impl *current_worksheet_;
 };
 
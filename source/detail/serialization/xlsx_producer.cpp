@@ -21,13 +21,17 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <atomic>
 #include <cmath>
 #include <numeric> // for std::accumulate
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <detail/constants.hpp>
+#include <detail/implementations/shared_formula.hpp>
 #include <detail/implementations/workbook_impl.hpp>
+#include <detail/parallel.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
@@ -52,6 +56,114 @@ bool is_integral(long double d)
     return std::fabs(d - static_cast<long double>(static_cast<long long int>(d))) == 0.L;
 }
 
+/// <summary>
+/// Returns a key identifying the cell at reference within its worksheet.
+/// </summary>
+std::uint64_t cell_key(const xlnt::cell_reference &reference)
+{
+    return (static_cast<std::uint64_t>(reference.row()) << 32) | reference.column_index();
+}
+
+/// <summary>
+/// Returns the next row after row that has cells, or 0 if there is none.
+/// </summary>
+xlnt::row_t next_stored_row(const xlnt::detail::cell_store &cells, xlnt::row_t row)
+{
+    return row < cells.last_row()
+        ? cells.next_row(row + 1, cells.last_row(), cells.first_column(), cells.last_column())
+        : 0;
+}
+
+/// <summary>
+/// The part a cell plays in a shared formula group.
+/// </summary>
+struct shared_formula_member
+{
+    std::size_t index;
+
+    /// <summary>
+    /// The range covered by the group. This is only set for the master cell, which
+    /// is the only cell of the group whose formula is written.
+    /// </summary>
+    std::string reference;
+};
+
+/// <summary>
+/// Finds runs of two or more vertically adjacent cells whose formulas differ only
+/// in their relative references, as when a formula is filled down a column, and
+/// returns the group of each cell in such a run keyed by cell_key.
+/// </summary>
+std::unordered_map<std::uint64_t, shared_formula_member> find_shared_formulae(const xlnt::detail::worksheet_impl &ws)
+{
+    struct run
+    {
+        std::string relative_formula;
+        xlnt::row_t first;
+        xlnt::row_t last;
+    };
+
+    std::unordered_map<std::uint64_t, shared_formula_member> members;
+    std::unordered_map<xlnt::column_t::index_t, run> open_runs;
+    std::size_t next_index = 0;
+
+    auto close = [&](xlnt::column_t::index_t column, const run &closed) {
+        if (closed.last == closed.first) return;
+
+        const auto index = next_index++;
+        const auto range = xlnt::range_reference(xlnt::cell_reference(column, closed.first),
+            xlnt::cell_reference(column, closed.last));
+
+        members[cell_key(range.top_left())] = shared_formula_member{index, range.to_string()};
+
+        for (auto row = closed.first + 1; row <= closed.last; ++row)
+        {
+            members[cell_key(xlnt::cell_reference(column, row))] = shared_formula_member{index, std::string()};
+        }
+    };
+
+    ws.cell_map_.for_each_row([&](xlnt::row_t row, const xlnt::detail::cell_store::cell_row &cells) {
+        for (const auto &e : cells)
+        {
+            const auto column = e.column;
+            auto open = open_runs.find(column);
+
+            if (!e.cell->has_formula_)
+            {
+                if (open != open_runs.end())
+                {
+                    close(column, open->second);
+                    open_runs.erase(open);
+                }
+
+                continue;
+            }
+
+            auto relative = xlnt::detail::relative_formula(ws.formula(*e.cell), row, column);
+
+            if (open != open_runs.end())
+            {
+                if (open->second.last + 1 == row && open->second.relative_formula == relative)
+                {
+                    open->second.last = row;
+                    continue;
+                }
+
+                close(column, open->second);
+                open_runs.erase(open);
+            }
+
+            open_runs.emplace(column, run{std::move(relative), row, row});
+        }
+    });
+
+    for (const auto &open : open_runs)
+    {
+        close(open.first, open.second);
+    }
+
+    return members;
+}
+
 std::vector<std::pair<std::string, std::string>> core_property_namespace(xlnt::core_property type)
 {
     using xlnt::core_property;
@@ -99,12 +211,14 @@ xlsx_producer::~xlsx_producer()
 void xlsx_producer::write(std::ostream &destination)
 {
     archive_.reset(new ozstream(destination));
+    archive_->compress_in_blocks(source_.compression_block_size(), source_.thread_count());
     populate_archive(false);
 }
 
 void xlsx_producer::open(std::ostream &destination)
 {
     archive_.reset(new ozstream(destination));
+    archive_->compress_in_blocks(source_.compression_block_size(), source_.thread_count());
     populate_archive(true);
 }
 
@@ -177,13 +291,30 @@ void xlsx_producer::end_part()
         current_part_serializer_.reset();
     }
 
+    if (worker_ && current_part_streambuf_)
+    {
+        worker_parts_.push_back(
+            ozstream::compress_entry(worker_part_path_, worker_part_, source_.compression_block_size()));
+        worker_part_.clear();
+    }
+
     current_part_streambuf_.reset();
 }
 
 void xlsx_producer::begin_part(const path &part)
 {
     end_part();
-    current_part_streambuf_ = archive_->open(part);
+
+    if (worker_)
+    {
+        worker_part_path_ = part;
+        current_part_streambuf_.reset(new vector_ostreambuf(worker_part_));
+    }
+    else
+    {
+        current_part_streambuf_ = archive_->open(part);
+    }
+
     current_part_stream_.rdbuf(current_part_streambuf_.get());
     current_part_serializer_.reset(new xml::serializer(current_part_stream_, part.string()));
 }
@@ -638,10 +769,42 @@ void xlsx_producer::write_workbook(const relationship &rel)
     auto workbook_rels = source_.manifest().relationships(rel.target().path());
     write_relationships(workbook_rels, rel.target().path());
 
+    // with several threads, worksheets are rendered up front and their finished parts
+    // are appended below in the same place they would otherwise have been written
+    std::vector<std::vector<zentry>> worksheet_parts;
+    const auto thread_count = resolve_thread_count(source_.thread_count());
+
+    if (!streaming_ && thread_count > 1)
+    {
+        std::vector<relationship> worksheet_rels;
+
+        std::copy_if(workbook_rels.begin(), workbook_rels.end(), std::back_inserter(worksheet_rels),
+            [](const relationship &r) { return r.type() == relationship_type::worksheet; });
+
+        if (worksheet_rels.size() > 1)
+        {
+            worksheet_parts = write_worksheets(worksheet_rels, thread_count);
+        }
+    }
+
+    auto next_worksheet_parts = worksheet_parts.begin();
+
     for (const auto &child_rel : workbook_rels)
     {
         if (child_rel.type() == relationship_type::calculation_chain) continue;
 
+        if (child_rel.type() == relationship_type::worksheet && next_worksheet_parts != worksheet_parts.end())
+        {
+            end_part();
+
+            for (const auto &part : *next_worksheet_parts++)
+            {
+                archive_->append(part);
+            }
+
+            continue;
+        }
+
         path archive_path(child_rel.source().path().parent().append(child_rel.target().path()));
         begin_part(archive_path);
 
@@ -788,56 +951,49 @@ void xlsx_producer::write_shared_string_table(const relationship & /*rel*/)
     write_start_element(xmlns, "sst");
     write_namespace(xmlns, "");
 
-    // todo: is there a more elegant way to get this number?
+    // walk the stored cells rather than every coordinate in each dimension
     std::size_t string_count = 0;
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wrange-loop-analysis"
     for (const auto ws : source_)
     {
-        auto dimension = ws.calculate_dimension();
-        auto current_cell = dimension.top_left();
-
-        while (current_cell.row() <= dimension.bottom_right().row())
-        {
-            while (current_cell.column() <= dimension.bottom_right().column())
+        ws.d_->cell_map_.for_each([&string_count](const detail::cell_impl &cell) {
+            if (cell.type_ == cell::type::shared_string)
             {
-                if (ws.has_cell(current_cell)
-                    && ws.cell(current_cell).data_type() == cell::type::shared_string)
-                {
-                    ++string_count;
-                }
-
-                current_cell.column_index(current_cell.column_index() + 1);
+                ++string_count;
             }
-
-            current_cell.row(current_cell.row() + 1);
-            current_cell.column_index(dimension.top_left().column_index());
-        }
+        });
     }
 #pragma clang diagnostic pop
 
     write_attribute("count", string_count);
-    write_attribute("uniqueCount", source_.shared_strings().size());
+    const auto &strings = source_.d_->shared_strings_;
+    write_attribute("uniqueCount", strings.size());
 
     auto has_trailing_whitespace = [](const std::string &s)
     {
         return !s.empty() && (s.front() == ' ' || s.back() == ' ');
     };
 
-    for (const auto &string : source_.shared_strings())
+    for (std::size_t index = 0; index < strings.size(); ++index)
     {
-        if (string.runs().size() == 1 && !string.runs().at(0).second.is_set())
+        // plain entries are written straight from the character storage
+        if (!strings.is_rich(index))
         {
+            const auto text = strings.text(index).to_string();
+
             write_start_element(xmlns, "si");
             write_start_element(xmlns, "t");
-            write_characters(string.plain_text(), has_trailing_whitespace(string.plain_text()));
+            write_characters(text, has_trailing_whitespace(text));
             write_end_element(xmlns, "t");
             write_end_element(xmlns, "si");
 
             continue;
         }
 
+        const auto string = strings.at(index);
+
         write_start_element(xmlns, "si");
 
         for (const auto &run : string.runs())
@@ -2175,20 +2331,89 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
     write_start_element(xmlns, "sheetData");
 
-    for (auto row : ws.rows(false))
+    // Rows without cells are only written if they have properties. They're
+    // interleaved in order with the populated rows visited below.
+    std::vector<row_t> property_rows;
+
+    if (!ws.d_->cell_map_.empty())
+    {
+        for (const auto &props : ws.d_->row_properties_)
+        {
+            if (props.first >= ws.lowest_row() && props.first <= ws.highest_row()
+                && ws.d_->cell_map_.find_row(props.first) == nullptr)
+            {
+                property_rows.push_back(props.first);
+            }
+        }
+
+        std::sort(property_rows.begin(), property_rows.end());
+    }
+
+    auto write_row_attributes = [&](row_t row_index) {
+        if (!ws.has_row_properties(row_index)) return;
+
+        const auto &props = ws.row_properties(row_index);
+
+        if (props.custom_height || props.height.is_set())
+        {
+            write_attribute("customHeight", write_bool(true));
+        }
+
+        if (props.height.is_set())
+        {
+            auto height = props.height.get();
+
+            if (std::fabs(height - std::floor(height)) == 0.0)
+            {
+                write_attribute("ht", std::to_string(static_cast<int>(height)) + ".0");
+            }
+            else
+            {
+                write_attribute("ht", height);
+            }
+        }
+
+        if (props.hidden)
+        {
+            write_attribute("hidden", write_bool(true));
+        }
+    };
+
+    auto next_property_row = property_rows.begin();
+
+    auto write_property_rows_before = [&](row_t row_index) {
+        while (next_property_row != property_rows.end() && *next_property_row < row_index)
+        {
+            write_start_element(xmlns, "row");
+            write_attribute("r", *next_property_row);
+            write_row_attributes(*next_property_row);
+            write_end_element(xmlns, "row");
+            ++next_property_row;
+        }
+    };
+
+    // formulas filled down a column are written once, as a shared formula
+    const auto shared_formulae = find_shared_formulae(*ws.d_);
+
+    const detail::cell_store &stored_cells = ws.d_->cell_map_;
+
+    for (auto row_index = stored_cells.empty() ? row_t(0) : stored_cells.first_row(); row_index != 0;
+         row_index = next_stored_row(stored_cells, row_index))
     {
-        auto row_index = row.front().row();
+        const auto &row = *stored_cells.find_row(row_index);
 
+        write_property_rows_before(row_index);
         write_start_element(xmlns, "row");
 
         write_attribute("r", row_index);
 
-        auto min = static_cast<xlnt::row_t>(row.length());
+        auto min = constants::max_column().index;
         xlnt::row_t max = 0;
         bool any_non_null = false;
 
-        for (auto cell : row)
+        for (const auto &e : row)
         {
+            xlnt::cell cell(e.cell);
             min = std::min(min, cell.column().index);
             max = std::max(max, cell.column().index);
 
@@ -2203,37 +2428,12 @@ void xlsx_producer::write_worksheet(const relationship &rel)
             write_attribute("spans", std::to_string(min) + ":" + std::to_string(max));
         }
 
-        if (ws.has_row_properties(row_index))
-        {
-            const auto &props = ws.row_properties(row_index);
+        write_row_attributes(row_index);
 
-            if (props.custom_height || props.height.is_set())
-            {
-                write_attribute("customHeight", write_bool(true));
-            }
-
-            if (props.height.is_set())
-            {
-                auto height = props.height.get();
-
-                if (std::fabs(height - std::floor(height)) == 0.0)
-                {
-                    write_attribute("ht", std::to_string(static_cast<int>(height)) + ".0");
-                }
-                else
-                {
-                    write_attribute("ht", height);
-                }
-            }
-
-            if (props.hidden)
-            {
-                write_attribute("hidden", write_bool(true));
-            }
-        }
-
-        for (auto cell : row) // CT_Cell
+        for (const auto &e : row) // CT_Cell
         {
+            xlnt::cell cell(e.cell);
+
             if (cell.garbage_collectible()) continue;
 
             // record data about the cell needed later
@@ -2301,7 +2501,33 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
             if (cell.has_formula())
             {
-                write_element(xmlns, "f", cell.formula());
+                auto shared = shared_formulae.find(cell_key(cell.reference()));
+
+                if (shared == shared_formulae.end())
+                {
+                    write_element(xmlns, "f", cell.formula());
+                }
+                else
+                {
+                    const auto is_master = !shared->second.reference.empty();
+
+                    write_start_element(xmlns, "f");
+                    write_attribute("t", "shared");
+
+                    if (is_master)
+                    {
+                        write_attribute("ref", shared->second.reference);
+                    }
+
+                    write_attribute("si", shared->second.index);
+
+                    if (is_master)
+                    {
+                        write_characters(cell.formula());
+                    }
+
+                    write_end_element(xmlns, "f");
+                }
             }
 
             switch (cell.data_type())
@@ -2337,10 +2563,7 @@ void xlsx_producer::write_worksheet(const relationship &rel)
                 }
                 else
                 {
-                    std::stringstream ss;
-                    ss.precision(20);
-                    ss << cell.value<long double>();
-                    write_characters(ss.str());
+                    write_characters(serialize_number(cell.d_->value_numeric_));
                 }
 
                 write_end_element(xmlns, "v");
@@ -2361,6 +2584,7 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "row");
     }
 
+    write_property_rows_before(constants::max_row());
     write_end_element(xmlns, "sheetData");
 
     if (ws.has_auto_filter())
@@ -2692,9 +2916,34 @@ void xlsx_producer::write_worksheet(const relationship &rel)
     }
 }
 
+std::vector<std::vector<zentry>> xlsx_producer::write_worksheets(
+    const std::vector<relationship> &worksheet_rels, std::size_t thread_count)
+{
+    std::vector<std::vector<zentry>> parts(worksheet_rels.size());
+    std::atomic<std::size_t> next(0);
+
+    // each thread takes the next unwritten worksheet, so one large worksheet doesn't hold up the rest
+    parallel_for(thread_count, thread_count, [&](std::size_t) {
+        for (auto i = next++; i < worksheet_rels.size(); i = next++)
+        {
+            xlsx_producer worker(source_);
+            worker.worker_ = true;
+
+            const auto &rel = worksheet_rels[i];
+            worker.begin_part(rel.source().path().parent().append(rel.target().path()));
+            worker.write_worksheet(rel);
+            worker.end_part();
+
+            parts[i] = std::move(worker.worker_parts_);
+        }
+    });
+
+    return parts;
+}
+
 // Sheet Relationship Target Parts
 
-void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws, const std::vector<cell_reference> &cells)
+void xlsx_producer::write_comments(const relationship & /*rel*/, const worksheet &ws, const std::vector<cell_reference> &cells)
 {
     static const auto &xmlns = constants::ns("spreadsheetml");
 
@@ -2707,8 +2956,7 @@ void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws, c
 
         for (auto cell_ref : cells)
         {
-            auto cell = ws.cell(cell_ref);
-            auto author = cell.comment().author();
+            auto author = ws.d_->comments_.at(cell_key(cell_ref)).author();
 
             if (authors.find(author) == authors.end())
             {
@@ -2733,8 +2981,7 @@ void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws, c
         {
             write_start_element(xmlns, "comment");
 
-            auto cell = ws.cell(cell_ref);
-            auto cell_comment = cell.comment();
+            const auto &cell_comment = ws.d_->comments_.at(cell_key(cell_ref));
 
             write_attribute("ref", cell_ref.to_string());
             auto author_id = authors.at(cell_comment.author());
@@ -2807,7 +3054,7 @@ void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws, c
     write_end_element(xmlns, "comments");
 }
 
-void xlsx_producer::write_vml_drawings(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells)
+void xlsx_producer::write_vml_drawings(const relationship &rel, const worksheet &ws, const std::vector<cell_reference> &cells)
 {
     static const auto &xmlns_mv = std::string("http://macVmlSchemaUri");
     static const auto &xmlns_o = std::string("urn:schemas-microsoft-com:office:office");
@@ -2857,7 +3104,7 @@ void xlsx_producer::write_vml_drawings(const relationship &rel, worksheet ws, co
 
     for (const auto &cell_ref : cells)
     {
-        auto comment = ws.cell(cell_ref).comment();
+        const auto &comment = ws.d_->comments_.at(cell_key(cell_ref));
         auto shape_id = 1024 * file_index + 1 + comment_index * 2;
 
         write_start_element(xmlns_v, "shape");
@@ -30,6 +30,9 @@
 
 #include <detail/constants.hpp>
 #include <detail/external/include_libstudxml.hpp>
+#include <detail/serialization/number_serialization.hpp>
+#include <detail/serialization/zstream.hpp>
+#include <xlnt/utils/path.hpp>
 
 namespace xml {
 class serializer;
@@ -52,7 +55,6 @@ class worksheet;
 
 namespace detail {
 
-class ozstream;
 struct cell_impl;
 struct worksheet_impl;
 
@@ -119,10 +121,19 @@ private:
 	void write_dialogsheet(const relationship &rel);
 	void write_worksheet(const relationship &rel);
 
+    /// <summary>
+    /// Writes worksheets, and the parts which belong to them, on up to thread_count
+    /// threads. Each worksheet is written by its own worker producer, which deflates its
+    /// parts into memory rather than into archive_. Returns the finished parts of each
+    /// worksheet, in the order of worksheet_rels, to be appended to archive_.
+    /// </summary>
+    std::vector<std::vector<zentry>> write_worksheets(
+        const std::vector<relationship> &worksheet_rels, std::size_t thread_count);
+
 	// Sheet Relationship Target Parts
 
-	void write_comments(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells);
-	void write_vml_drawings(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells);
+	void write_comments(const relationship &rel, const worksheet &ws, const std::vector<cell_reference> &cells);
+	void write_vml_drawings(const relationship &rel, const worksheet &ws, const std::vector<cell_reference> &cells);
 
 	// Other Parts
 
@@ -177,6 +188,20 @@ private:
         current_part_serializer_->attribute(name, value);
     }
 
+    /// <summary>
+    /// Doubles are written as the shortest text that reads back exactly rather than
+    /// with the six significant digits a stream would use by default.
+    /// </summary>
+    void write_attribute(const std::string &name, double value)
+    {
+        current_part_serializer_->attribute(name, serialize_number(value));
+    }
+
+    void write_attribute(const xml::qname &name, double value)
+    {
+        current_part_serializer_->attribute(name, serialize_number(value));
+    }
+
     template<typename T>
     void write_characters(T characters, bool preserve_whitespace = false)
     {
@@ -200,6 +225,16 @@ private:
 
     bool streaming_ = false;
 
+    /// <summary>
+    /// True for a producer writing a single worksheet on a worker thread. Such a producer
+    /// has no archive_. Each part it begins is written to worker_part_ and deflated into
+    /// worker_parts_ when it ends. It only reads the workbook.
+    /// </summary>
+    bool worker_ = false;
+    path worker_part_path_;
+    std::vector<std::uint8_t> worker_part_;
+    std::vector<zentry> worker_parts_;
+
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
     detail::cell_impl *current_cell_;
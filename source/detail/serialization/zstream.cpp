@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 #include <string>
 
 #include <xlnt/utils/exceptions.hpp>
+#include <detail/parallel.hpp>
 #include <detail/serialization/miniz.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/zstream.hpp>
@@ -164,6 +165,79 @@ void write_header(const xlnt::detail::zheader &header, std::ostream &ostream, co
     }
 }
 
+std::uint32_t gf2_matrix_times(const std::array<std::uint32_t, 32> &matrix, std::uint32_t vector)
+{
+    std::uint32_t sum = 0;
+
+    for (std::size_t i = 0; vector != 0; ++i, vector >>= 1)
+    {
+        if (vector & 1)
+        {
+            sum ^= matrix[i];
+        }
+    }
+
+    return sum;
+}
+
+void gf2_matrix_square(std::array<std::uint32_t, 32> &square, const std::array<std::uint32_t, 32> &matrix)
+{
+    for (std::size_t i = 0; i < 32; ++i)
+    {
+        square[i] = gf2_matrix_times(matrix, matrix[i]);
+    }
+}
+
+/// <summary>
+/// Returns the CRC-32 of two pieces of data one after the other from the CRC-32 of
+/// each and the length of the second, as zlib's crc32_combine does. miniz has no
+/// equivalent.
+/// </summary>
+std::uint32_t combine_crc32(std::uint32_t first_crc, std::uint32_t second_crc, std::uint64_t second_length)
+{
+    if (second_length == 0) return first_crc;
+
+    // odd is the operator which appends one zero bit to a CRC, even the one which appends two
+    std::array<std::uint32_t, 32> even;
+    std::array<std::uint32_t, 32> odd;
+
+    odd[0] = 0xedb88320; // reflected CRC-32 polynomial
+
+    for (std::size_t i = 1; i < 32; ++i)
+    {
+        odd[i] = std::uint32_t(1) << (i - 1);
+    }
+
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+
+    // append second_length zero bytes to first_crc, squaring the operator for each bit of the length
+    do
+    {
+        gf2_matrix_square(even, odd);
+
+        if (second_length & 1)
+        {
+            first_crc = gf2_matrix_times(even, first_crc);
+        }
+
+        second_length >>= 1;
+
+        if (second_length == 0) break;
+
+        gf2_matrix_square(odd, even);
+
+        if (second_length & 1)
+        {
+            first_crc = gf2_matrix_times(odd, first_crc);
+        }
+
+        second_length >>= 1;
+    } while (second_length != 0);
+
+    return first_crc ^ second_crc;
+}
+
 } // namespace
 
 namespace xlnt {
@@ -445,6 +519,209 @@ int zip_streambuf_compress::overflow(int c)
     return c;
 }
 
+/// <summary>
+/// The most data a deflate match can reach back over.
+/// </summary>
+static const std::size_t deflate_window_size = 32768;
+
+/// <summary>
+/// Deflates size bytes from data with strm, appending the output to output. With
+/// Z_SYNC_FLUSH the output ends on a byte boundary with the dictionary kept, so
+/// independently compressed pieces can be concatenated into one deflate stream.
+/// </summary>
+static void deflate_into(z_stream &strm, const char *data, std::size_t size, int flush, std::vector<std::uint8_t> &output)
+{
+    strm.next_in = reinterpret_cast<const unsigned char *>(data);
+    strm.avail_in = static_cast<unsigned int>(size);
+
+    while (true)
+    {
+        const auto used = output.size();
+        output.resize(used + std::max(size / 2, std::size_t(4096)));
+        strm.next_out = output.data() + used;
+        strm.avail_out = static_cast<unsigned int>(output.size() - used);
+
+        const auto result = deflate(&strm, flush);
+        output.resize(output.size() - strm.avail_out);
+
+        if (result == Z_STREAM_END) break;
+
+        if (result != Z_OK)
+        {
+            throw xlnt::exception("couldn't deflate ZIP entry");
+        }
+
+        if (flush != Z_FINISH && strm.avail_in == 0 && strm.avail_out != 0) break;
+    }
+}
+
+/// <summary>
+/// Deflates size bytes from data into a piece of a raw deflate stream. The compressor
+/// first sees the dictionary_size bytes before data, which are discarded once
+/// compressed, so matches may reach back into them as they would in a single stream.
+/// Unless last is true, the piece ends with a sync flush so another can follow it.
+/// </summary>
+static std::vector<std::uint8_t> deflate_block(const char *data, std::size_t size, std::size_t dictionary_size, bool last)
+{
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+#pragma clang diagnostic pop
+    {
+        throw xlnt::exception("couldn't deflate ZIP entry");
+    }
+
+    std::vector<std::uint8_t> output;
+
+    try
+    {
+        if (dictionary_size > 0)
+        {
+            deflate_into(strm, data - dictionary_size, dictionary_size, Z_SYNC_FLUSH, output);
+            output.clear();
+        }
+
+        deflate_into(strm, data, size, last ? Z_FINISH : Z_SYNC_FLUSH, output);
+    }
+    catch (...)
+    {
+        deflateEnd(&strm);
+        throw;
+    }
+
+    deflateEnd(&strm);
+
+    return output;
+}
+
+/// <summary>
+/// Compresses a file in blocks of block_size bytes, deflating up to thread_count
+/// blocks at a time like pigz. The blocks are concatenated into one deflate stream:
+/// each ends with a sync flush, except the last, and each is primed with up to 32KiB
+/// of data before it. The CRCs of the blocks are computed alongside and combined. The
+/// output depends on block_size but not on thread_count.
+/// </summary>
+class zip_streambuf_block_compress : public std::streambuf
+{
+public:
+    zip_streambuf_block_compress(
+        zheader *central_header, std::ostream &stream, std::size_t block_size, std::size_t thread_count)
+        : ostream_(stream),
+          header_(central_header),
+          block_size_(block_size),
+          thread_count_(thread_count),
+          buffer_(deflate_window_size + block_size * thread_count)
+    {
+        setg(0, 0, 0);
+        setp(buffer_.data() + deflate_window_size, buffer_.data() + buffer_.size());
+
+        header_->header_offset = static_cast<std::uint32_t>(ostream_.tellp());
+        write_header(*header_, ostream_, false);
+    }
+
+    virtual ~zip_streambuf_block_compress()
+    {
+        try
+        {
+            compress(true);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
+
+        std::streampos final_position = ostream_.tellp();
+        header_->uncompressed_size = static_cast<std::uint32_t>(uncompressed_size_);
+        header_->crc = crc_;
+        ostream_.seekp(header_->header_offset);
+        write_header(*header_, ostream_, false);
+        ostream_.seekp(final_position);
+    }
+
+protected:
+    virtual int underflow()
+    {
+        throw xlnt::exception("Attempt to read write only ostream");
+    }
+
+    virtual int overflow(int c = EOF)
+    {
+        // more data is coming, so none of the pending blocks is the last one
+        compress(false);
+
+        if (c != EOF)
+        {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+private:
+    /// <summary>
+    /// Compresses the pending data, which is a whole number of blocks unless last is true,
+    /// and writes it to the archive.
+    /// </summary>
+    void compress(bool last)
+    {
+        const auto first = pbase();
+        const auto size = static_cast<std::size_t>(pptr() - pbase());
+        const auto count = std::max((size + block_size_ - 1) / block_size_, std::size_t(last ? 1 : 0));
+
+        std::vector<std::vector<std::uint8_t>> blocks(count);
+        std::vector<std::uint32_t> crcs(count);
+
+        parallel_for(count, thread_count_, [&](std::size_t i) {
+            const auto offset = i * block_size_;
+            const auto length = std::min(block_size_, size - std::min(size, offset));
+            const auto data = first + offset;
+
+            // the end of the data compressed last is kept in front of the first block
+            const auto dictionary_size = std::min(window_size_ + offset, deflate_window_size);
+
+            blocks[i] = deflate_block(data, length, dictionary_size, last && i + 1 == count);
+            crcs[i] = static_cast<std::uint32_t>(crc32(0, reinterpret_cast<const unsigned char *>(data), length));
+        });
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto length = std::min(block_size_, size - std::min(size, i * block_size_));
+
+            ostream_.write(reinterpret_cast<const char *>(blocks[i].data()), static_cast<std::streamsize>(blocks[i].size()));
+            header_->compressed_size += static_cast<std::uint32_t>(blocks[i].size());
+            crc_ = combine_crc32(crc_, crcs[i], length);
+            uncompressed_size_ += length;
+        }
+
+        // keep the end of everything so far in front of the next data, to prime its first block
+        window_size_ = std::min(window_size_ + size, deflate_window_size);
+        std::copy(pptr() - window_size_, pptr(), pbase() - window_size_);
+        setp(pbase(), epptr());
+    }
+
+    std::ostream &ostream_;
+    zheader *header_;
+    std::size_t block_size_;
+    std::size_t thread_count_;
+
+    /// <summary>
+    /// The data waiting to be compressed, which starts deflate_window_size bytes into
+    /// buffer_. The window_size_ bytes before it are the end of the data compressed last.
+    /// </summary>
+    std::vector<char> buffer_;
+    std::size_t window_size_ = 0;
+
+    std::uint32_t crc_ = 0;
+    std::uint64_t uncompressed_size_ = 0;
+};
+
 ozstream::ozstream(std::ostream &stream)
     : destination_stream_(stream)
 {
@@ -482,11 +759,58 @@ std::unique_ptr<std::streambuf> ozstream::open(const path &filename)
     zheader header;
     header.filename = filename.string();
     file_headers_.push_back(header);
+
+    if (block_size_ > 0)
+    {
+        return std::unique_ptr<std::streambuf>(new zip_streambuf_block_compress(
+            &file_headers_.back(), destination_stream_, block_size_, block_thread_count_));
+    }
+
     auto buffer = new zip_streambuf_compress(&file_headers_.back(), destination_stream_);
 
     return std::unique_ptr<zip_streambuf_compress>(buffer);
 }
 
+void ozstream::compress_in_blocks(std::size_t block_size, std::size_t thread_count)
+{
+    block_size_ = block_size;
+    block_thread_count_ = resolve_thread_count(thread_count);
+}
+
+zentry ozstream::compress_entry(const path &file, const std::vector<std::uint8_t> &contents, std::size_t block_size)
+{
+    zentry entry;
+    entry.header.filename = file.string();
+
+    vector_ostreambuf entry_buffer(entry.data);
+    std::ostream entry_stream(&entry_buffer);
+
+    {
+        std::unique_ptr<std::streambuf> compressed;
+
+        if (block_size > 0)
+        {
+            compressed.reset(new zip_streambuf_block_compress(&entry.header, entry_stream, block_size, 1));
+        }
+        else
+        {
+            compressed.reset(new zip_streambuf_compress(&entry.header, entry_stream));
+        }
+
+        compressed->sputn(reinterpret_cast<const char *>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    }
+
+    return entry;
+}
+
+void ozstream::append(const zentry &entry)
+{
+    file_headers_.push_back(entry.header);
+    file_headers_.back().header_offset = static_cast<std::uint32_t>(destination_stream_.tellp());
+    destination_stream_.write(
+        reinterpret_cast<const char *>(entry.data.data()), static_cast<std::streamsize>(entry.data.size()));
+}
+
 izstream::izstream(std::istream &stream)
     : source_stream_(stream)
 {
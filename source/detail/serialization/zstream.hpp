@@ -68,6 +68,16 @@ struct XLNT_API zheader
     std::uint32_t header_offset = 0;
 };
 
+/// <summary>
+/// A file compressed ahead of time by ozstream::compress_entry: its local header followed by
+/// its compressed contents, ready to be added to an archive with ozstream::append.
+/// </summary>
+struct XLNT_API zentry
+{
+    zheader header;
+    std::vector<std::uint8_t> data;
+};
+
 /// <summary>
 /// Writes a series of uncompressed binary file data as ostreams into another ostream
 /// according to the ZIP format.
@@ -90,9 +100,33 @@ public:
     /// </summary>
     std::unique_ptr<std::streambuf> open(const path &file);
 
+    /// <summary>
+    /// Makes files opened after this call be deflated in blocks of block_size bytes, up
+    /// to thread_count blocks at a time, or one per hardware thread if thread_count is 0.
+    /// The blocks form a single deflate stream which depends on block_size but not on
+    /// thread_count. A block_size of 0 deflates each file as a single stream again.
+    /// </summary>
+    void compress_in_blocks(std::size_t block_size, std::size_t thread_count);
+
+    /// <summary>
+    /// Compresses contents as the file at the given path without writing it anywhere.
+    /// The result is the same as writing contents to a streambuf returned by open, with
+    /// compress_in_blocks(block_size, ...) if block_size isn't 0, so it can be done on
+    /// any thread and appended to an archive later.
+    /// </summary>
+    static zentry compress_entry(const path &file, const std::vector<std::uint8_t> &contents, std::size_t block_size = 0);
+
+    /// <summary>
+    /// Writes a file compressed by compress_entry after the files already in the archive.
+    /// Any streambuf returned by open must have been destroyed first.
+    /// </summary>
+    void append(const zentry &entry);
+
 private:
     std::vector<zheader> file_headers_;
     std::ostream &destination_stream_;
+    std::size_t block_size_ = 0;
+    std::size_t block_thread_count_ = 1;
 };
 
 /// <summary>
@@ -22,6 +22,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <detail/hash_combine.hpp>
 #include <xlnt/styles/alignment.hpp>
 
 namespace xlnt {
@@ -167,3 +168,21 @@ bool alignment::operator!=(const alignment &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::alignment>::operator()(const xlnt::alignment &a) const
+{
+    size_t seed = 0;
+
+    xlnt::detail::hash_combine(seed, a.shrink());
+    xlnt::detail::hash_combine(seed, a.wrap());
+    xlnt::detail::hash_combine(seed, a.indent().is_set() ? a.indent().get() : -1);
+    xlnt::detail::hash_combine(seed, a.rotation().is_set() ? a.rotation().get() : -1);
+    xlnt::detail::hash_combine(seed, a.horizontal().is_set() ? static_cast<int>(a.horizontal().get()) : -1);
+    xlnt::detail::hash_combine(seed, a.vertical().is_set() ? static_cast<int>(a.vertical().get()) : -1);
+
+    return seed;
+}
+
+} // namespace std
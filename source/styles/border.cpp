@@ -25,6 +25,7 @@
 #include <xlnt/styles/border.hpp>
 #include <xlnt/utils/exceptions.hpp>
 #include <detail/default_case.hpp>
+#include <detail/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -194,3 +195,35 @@ bool border::operator!=(const border &right) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::border>::operator()(const xlnt::border &b) const
+{
+    size_t seed = 0;
+
+    for (auto side : xlnt::border::all_sides())
+    {
+        const auto property = b.side(side);
+        xlnt::detail::hash_combine(seed, property.is_set());
+
+        if (!property.is_set())
+        {
+            continue;
+        }
+
+        if (property.get().style().is_set())
+        {
+            xlnt::detail::hash_combine(seed, static_cast<int>(property.get().style().get()));
+        }
+
+        if (property.get().color().is_set())
+        {
+            xlnt::detail::hash_combine(seed, property.get().color().get());
+        }
+    }
+
+    return seed;
+}
+
+} // namespace std
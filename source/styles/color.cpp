@@ -25,6 +25,7 @@
 #include <cmath>
 #include <cstdlib>
 
+#include <detail/hash_combine.hpp>
 #include <xlnt/styles/color.hpp>
 #include <xlnt/utils/exceptions.hpp>
 
@@ -285,3 +286,29 @@ bool color::operator!=(const color &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::color>::operator()(const xlnt::color &c) const
+{
+    // tint is left out since colors with equal tints may differ only by rounding
+    auto seed = static_cast<size_t>(c.type());
+    xlnt::detail::hash_combine(seed, c.auto_());
+
+    switch (c.type())
+    {
+    case xlnt::color_type::indexed:
+        xlnt::detail::hash_combine(seed, c.indexed().index());
+        break;
+    case xlnt::color_type::theme:
+        xlnt::detail::hash_combine(seed, c.theme().index());
+        break;
+    case xlnt::color_type::rgb:
+        xlnt::detail::hash_combine(seed, c.rgb().hex_string());
+        break;
+    }
+
+    return seed;
+}
+
+} // namespace std
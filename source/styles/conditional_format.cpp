@@ -88,7 +88,8 @@ xlnt::border conditional_format::border() const
 
 conditional_format conditional_format::border(const xlnt::border &new_border)
 {
-    d_->border_id = d_->parent->find_or_add(d_->parent->borders, new_border);
+    d_->parent->reassign(d_->parent->border_references, d_->border_id,
+        d_->parent->find_or_add(d_->parent->borders, d_->parent->border_index, new_border));
 	return *this;
 }
 
@@ -99,7 +100,8 @@ xlnt::fill conditional_format::fill() const
 
 conditional_format conditional_format::fill(const xlnt::fill &new_fill)
 {
-    d_->fill_id = d_->parent->find_or_add(d_->parent->fills, new_fill);
+    d_->parent->reassign(d_->parent->fill_references, d_->fill_id,
+        d_->parent->find_or_add(d_->parent->fills, d_->parent->fill_index, new_fill));
 	return *this;
 }
 
@@ -110,7 +112,8 @@ xlnt::font conditional_format::font() const
 
 conditional_format conditional_format::font(const xlnt::font &new_font)
 {
-    d_->font_id = d_->parent->find_or_add(d_->parent->fonts, new_font);
+    d_->parent->reassign(d_->parent->font_references, d_->font_id,
+        d_->parent->find_or_add(d_->parent->fonts, d_->parent->font_index, new_font));
 	return *this;
 }
 
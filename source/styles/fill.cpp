@@ -24,6 +24,7 @@
 
 #include <cmath> // for std::fabs
 
+#include <detail/hash_combine.hpp>
 #include <xlnt/styles/fill.hpp>
 
 namespace xlnt {
@@ -319,3 +320,35 @@ bool fill::operator!=(const fill &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::fill>::operator()(const xlnt::fill &f) const
+{
+    auto seed = static_cast<size_t>(f.type());
+
+    if (f.type() == xlnt::fill_type::gradient)
+    {
+        xlnt::detail::hash_combine(seed, static_cast<int>(f.gradient_fill().type()));
+        xlnt::detail::hash_combine(seed, f.gradient_fill().degree());
+
+        return seed;
+    }
+
+    const auto pattern = f.pattern_fill();
+    xlnt::detail::hash_combine(seed, static_cast<int>(pattern.type()));
+
+    if (pattern.foreground().is_set())
+    {
+        xlnt::detail::hash_combine(seed, pattern.foreground().get());
+    }
+
+    if (pattern.background().is_set())
+    {
+        xlnt::detail::hash_combine(seed, pattern.background().get());
+    }
+
+    return seed;
+}
+
+} // namespace std
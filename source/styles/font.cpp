@@ -24,6 +24,7 @@
 
 #include <cmath>
 
+#include <detail/hash_combine.hpp>
 #include <xlnt/styles/font.hpp>
 
 namespace xlnt {
@@ -287,3 +288,35 @@ bool font::operator==(const font &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::font>::operator()(const xlnt::font &f) const
+{
+    size_t seed = 0;
+
+    xlnt::detail::hash_combine(seed, f.bold());
+    xlnt::detail::hash_combine(seed, f.italic());
+    xlnt::detail::hash_combine(seed, f.strikethrough());
+    xlnt::detail::hash_combine(seed, f.superscript());
+    xlnt::detail::hash_combine(seed, static_cast<int>(f.underline()));
+
+    if (f.has_name())
+    {
+        xlnt::detail::hash_combine(seed, f.name());
+    }
+
+    if (f.has_size())
+    {
+        xlnt::detail::hash_combine(seed, f.size());
+    }
+
+    if (f.has_color())
+    {
+        xlnt::detail::hash_combine(seed, f.color());
+    }
+
+    return seed;
+}
+
+} // namespace std
@@ -36,7 +36,7 @@ format::format(detail::format_impl *d)
 
 void format::clear_style()
 {
-    d_->style.clear();
+    d_->parent->change_format(*d_, [](detail::format_impl &f) { f.style.clear(); });
 }
 
 format format::style(const xlnt::style &new_style)
@@ -47,7 +47,7 @@ format format::style(const xlnt::style &new_style)
 
 format format::style(const std::string &new_style)
 {
-    d_->style = new_style;
+    d_->parent->change_format(*d_, [&new_style](detail::format_impl &f) { f.style = new_style; });
     return format(d_);
 }
 
@@ -193,7 +193,7 @@ bool format::pivot_button() const
 
 void format::pivot_button(bool show)
 {
-    d_->pivot_button_ = show;
+    d_->parent->change_format(*d_, [show](detail::format_impl &f) { f.pivot_button_ = show; });
 }
 
 bool format::quote_prefix() const
@@ -203,7 +203,7 @@ bool format::quote_prefix() const
 
 void format::quote_prefix(bool quote)
 {
-    d_->quote_prefix_ = quote;
+    d_->parent->change_format(*d_, [quote](detail::format_impl &f) { f.quote_prefix_ = quote; });
 }
 
 
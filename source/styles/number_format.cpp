@@ -349,6 +349,19 @@ std::string number_format::format(long double number, calendar base_date) const
     return detail::number_formatter(format_string_, base_date).format_number(number);
 }
 
+void number_format::format(const long double *numbers, std::size_t count, calendar base_date,
+    std::string &buffer, std::vector<std::size_t> &offsets) const
+{
+    detail::number_formatter formatter(format_string_, base_date);
+    offsets.reserve(offsets.size() + count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        formatter.format_number(numbers[i], buffer);
+        offsets.push_back(buffer.size());
+    }
+}
+
 bool number_format::operator==(const number_format &other) const
 {
     return format_string_ == other.format_string_;
@@ -360,3 +373,13 @@ bool number_format::operator!=(const number_format &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::number_format>::operator()(const xlnt::number_format &f) const
+{
+    // equality only compares format strings, so the id mustn't contribute
+    return hash<string>()(f.format_string());
+}
+
+} // namespace std
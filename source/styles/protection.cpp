@@ -64,3 +64,12 @@ bool protection::operator!=(const protection &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::protection>::operator()(const xlnt::protection &p) const
+{
+    return static_cast<size_t>(p.locked()) | static_cast<size_t>(p.hidden()) << 1;
+}
+
+} // namespace std
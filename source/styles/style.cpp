@@ -99,7 +99,8 @@ bool style::alignment_applied() const
 
 style style::alignment(const xlnt::alignment &new_alignment, bool applied)
 {
-    d_->alignment_id = d_->parent->find_or_add(d_->parent->alignments, new_alignment);
+    d_->parent->reassign(d_->parent->alignment_references, d_->alignment_id,
+        d_->parent->find_or_add(d_->parent->alignments, d_->parent->alignment_index, new_alignment));
     d_->alignment_applied = applied;
 
 	return *this;
@@ -117,7 +118,8 @@ bool style::border_applied() const
 
 style style::border(const xlnt::border &new_border, bool applied)
 {
-    d_->border_id = d_->parent->find_or_add(d_->parent->borders, new_border);
+    d_->parent->reassign(d_->parent->border_references, d_->border_id,
+        d_->parent->find_or_add(d_->parent->borders, d_->parent->border_index, new_border));
     d_->border_applied = applied;
 
 	return *this;
@@ -135,7 +137,8 @@ bool style::fill_applied() const
 
 style style::fill(const xlnt::fill &new_fill, bool applied)
 {
-    d_->fill_id = d_->parent->find_or_add(d_->parent->fills, new_fill);
+    d_->parent->reassign(d_->parent->fill_references, d_->fill_id,
+        d_->parent->find_or_add(d_->parent->fills, d_->parent->fill_index, new_fill));
     d_->fill_applied = applied;
 
 	return *this;
@@ -153,7 +156,8 @@ bool style::font_applied() const
 
 style style::font(const xlnt::font &new_font, bool applied)
 {
-    d_->font_id = d_->parent->find_or_add(d_->parent->fonts, new_font);
+    d_->parent->reassign(d_->parent->font_references, d_->font_id,
+        d_->parent->find_or_add(d_->parent->fonts, d_->parent->font_index, new_font));
     d_->font_applied = applied;
 
 	return *this;
@@ -210,7 +214,8 @@ bool style::protection_applied() const
 
 style style::protection(const xlnt::protection &new_protection, bool applied)
 {
-    d_->protection_id = d_->parent->find_or_add(d_->parent->protections, new_protection);
+    d_->parent->reassign(d_->parent->protection_references, d_->protection_id,
+        d_->parent->find_or_add(d_->parent->protections, d_->parent->protection_index, new_protection));
     d_->protection_applied = applied;
 
     return *this;
@@ -94,15 +94,7 @@ void streaming_workbook_reader::begin_worksheet(const std::string &title)
     parser_.reset(new xml::parser(*part_stream_, part_path.string()));
     consumer_->parser_ = parser_.get();
 
-    consumer_->current_worksheet_ = nullptr;
-
-    for (auto &impl : workbook_->impl().worksheets_)
-    {
-        if (impl.title_ == title)
-        {
-            consumer_->current_worksheet_ = &impl;
-        }
-    }
+    consumer_->current_worksheet_ = workbook_->impl().find_sheet(title);
 
     if (consumer_->current_worksheet_ == nullptr)
     {
@@ -30,6 +30,7 @@
 
 #include <detail/constants.hpp>
 #include <detail/default_case.hpp>
+#include <detail/parallel.hpp>
 #include <detail/implementations/cell_impl.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
@@ -49,8 +50,10 @@
 #include <xlnt/styles/number_format.hpp>
 #include <xlnt/styles/protection.hpp>
 #include <xlnt/styles/style.hpp>
+#include <xlnt/utils/allocation_statistics.hpp>
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/path.hpp>
+#include <xlnt/utils/string_view.hpp>
 #include <xlnt/utils/variant.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
@@ -94,6 +97,19 @@ bool contains(const std::vector<std::pair<T, xlnt::variant>> &container, const T
     return false;
 }
 
+/// <summary>
+/// Returns every cell of ws in row-major order. Taking the pointers up front keeps
+/// them valid while callers create cells, which may reorganize the store.
+/// </summary>
+std::vector<xlnt::detail::cell_impl *> stored_cells(xlnt::detail::worksheet_impl &ws)
+{
+    std::vector<xlnt::detail::cell_impl *> cells;
+    cells.reserve(ws.cell_map_.size());
+    ws.cell_map_.for_each([&cells](xlnt::detail::cell_impl &c) { cells.push_back(&c); });
+
+    return cells;
+}
+
 xlnt::path default_path(xlnt::relationship_type type, std::size_t index = 0)
 {
     using xlnt::path;
@@ -595,56 +611,46 @@ void workbook::register_worksheet_part(worksheet ws, relationship_type type)
 
 const worksheet workbook::sheet_by_title(const std::string &title) const
 {
-    for (auto &impl : d_->worksheets_)
+    auto match = d_->find_sheet(title);
+
+    if (match == nullptr)
     {
-        if (impl.title_ == title)
-        {
-            return worksheet(&impl);
-        }
+        throw key_not_found();
     }
 
-    throw key_not_found();
+    return worksheet(match);
 }
 
 worksheet workbook::sheet_by_title(const std::string &title)
 {
-    for (auto &impl : d_->worksheets_)
+    auto match = d_->find_sheet(title);
+
+    if (match == nullptr)
     {
-        if (impl.title_ == title)
-        {
-            return worksheet(&impl);
-        }
+        throw key_not_found();
     }
 
-    throw key_not_found();
+    return worksheet(match);
 }
 
 worksheet workbook::sheet_by_index(std::size_t index)
 {
-    if (index >= d_->worksheets_.size())
+    if (index >= d_->sheets_by_index_.size())
     {
         throw invalid_parameter();
     }
 
-    auto iter = d_->worksheets_.begin();
-
-    for (std::size_t i = 0; i < index; ++i)
-    {
-        ++iter;
-    }
-
-    return worksheet(&*iter);
+    return worksheet(d_->sheets_by_index_[index]);
 }
 
 const worksheet workbook::sheet_by_index(std::size_t index) const
 {
-    auto iter = d_->worksheets_.begin();
-
-    for (std::size_t i = 0; i < index; ++i, ++iter)
+    if (index >= d_->sheets_by_index_.size())
     {
+        throw invalid_parameter();
     }
 
-    return worksheet(&*iter);
+    return worksheet(d_->sheets_by_index_[index]);
 }
 
 worksheet workbook::sheet_by_id(std::size_t id)
@@ -703,7 +709,7 @@ worksheet workbook::create_sheet()
     auto sheet_id = d_->worksheets_.size() + 1;
     std::string sheet_filename = "sheet" + std::to_string(sheet_id) + ".xml";
 
-    d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    auto &impl = d_->insert_sheet(d_->worksheets_.size(), this, sheet_id, title);
 
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     uri relative_sheet_uri(path("worksheets").append(sheet_filename).string());
@@ -716,17 +722,19 @@ worksheet workbook::create_sheet()
 
     update_sheet_properties();
 
-    return worksheet(&d_->worksheets_.back());
+    return worksheet(&impl);
 }
 
 worksheet workbook::copy_sheet(worksheet to_copy)
 {
     if (to_copy.d_->parent_ != this) throw invalid_parameter();
 
-    detail::worksheet_impl impl(*to_copy.d_);
     auto new_sheet = create_sheet();
-    impl.title_ = new_sheet.title();
-    *new_sheet.d_ = impl;
+    const auto title = new_sheet.title();
+
+    // copied straight into the new sheet, keeping the title create_sheet chose
+    *new_sheet.d_ = *to_copy.d_;
+    new_sheet.d_->title_ = title;
 
     return new_sheet;
 }
@@ -734,32 +742,21 @@ worksheet workbook::copy_sheet(worksheet to_copy)
 worksheet workbook::copy_sheet(worksheet to_copy, std::size_t index)
 {
     copy_sheet(to_copy);
-
-    if (index != d_->worksheets_.size() - 1)
-    {
-        auto iter = d_->worksheets_.begin();
-
-        for (std::size_t i = 0; i < index; ++i, ++iter)
-        {
-        }
-
-        d_->worksheets_.insert(iter, d_->worksheets_.back());
-        d_->worksheets_.pop_back();
-    }
+    d_->move_sheet(d_->worksheets_.size() - 1, index);
 
     return sheet_by_index(index);
 }
 
 std::size_t workbook::index(worksheet ws)
 {
-    auto match = std::find(begin(), end(), ws);
+    auto match = std::find(d_->sheets_by_index_.begin(), d_->sheets_by_index_.end(), ws.d_);
 
-    if (match == end())
+    if (match == d_->sheets_by_index_.end())
     {
         throw invalid_parameter();
     }
 
-    return static_cast<std::size_t>(std::distance(begin(), match));
+    return static_cast<std::size_t>(match - d_->sheets_by_index_.begin());
 }
 
 void workbook::create_named_range(const std::string &name, worksheet range_owner, const std::string &reference_string)
@@ -955,10 +952,9 @@ void workbook::load(const std::wstring &filename, const std::string &password)
 
 void workbook::remove_sheet(worksheet ws)
 {
-    auto match_iter = std::find_if(
-        d_->worksheets_.begin(), d_->worksheets_.end(), [=](detail::worksheet_impl &comp) { return &comp == ws.d_; });
+    auto match_iter = std::find(d_->sheets_by_index_.begin(), d_->sheets_by_index_.end(), ws.d_);
 
-    if (match_iter == d_->worksheets_.end())
+    if (match_iter == d_->sheets_by_index_.end())
     {
         throw invalid_parameter();
     }
@@ -970,7 +966,7 @@ void workbook::remove_sheet(worksheet ws)
     d_->manifest_.unregister_override_type(ws_part);
     auto rel_id_map = d_->manifest_.unregister_relationship(wb_rel.target(), ws_rel_id);
     d_->sheet_title_rel_id_map_.erase(ws.title());
-    d_->worksheets_.erase(match_iter);
+    d_->erase_sheet(static_cast<std::size_t>(match_iter - d_->sheets_by_index_.begin()));
 
     // Shift sheet title->ID mappings down as a result of manifest::unregister_relationship above.
     for (auto &title_rel_id_pair : d_->sheet_title_rel_id_map_)
@@ -985,18 +981,7 @@ void workbook::remove_sheet(worksheet ws)
 worksheet workbook::create_sheet(std::size_t index)
 {
     create_sheet();
-
-    if (index != d_->worksheets_.size() - 1)
-    {
-        auto iter = d_->worksheets_.begin();
-
-        for (std::size_t i = 0; i < index; ++i, ++iter)
-        {
-        }
-
-        d_->worksheets_.insert(iter, d_->worksheets_.back());
-        d_->worksheets_.pop_back();
-    }
+    d_->move_sheet(d_->worksheets_.size() - 1, index);
 
     return sheet_by_index(index);
 }
@@ -1004,7 +989,7 @@ worksheet workbook::create_sheet(std::size_t index)
 worksheet workbook::create_sheet_with_rel(const std::string &title, const relationship &rel)
 {
     auto sheet_id = d_->worksheets_.size() + 1;
-    d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    auto &impl = d_->insert_sheet(d_->worksheets_.size(), this, sheet_id, title);
 
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     auto sheet_absoulute_path = workbook_rel.target().path().parent().append(rel.target().path());
@@ -1016,7 +1001,7 @@ worksheet workbook::create_sheet_with_rel(const std::string &title, const relati
 
     update_sheet_properties();
 
-    return worksheet(&d_->worksheets_.back());
+    return worksheet(&impl);
 }
 
 workbook::iterator workbook::begin()
@@ -1066,6 +1051,19 @@ std::size_t workbook::sheet_count() const
     return d_->worksheets_.size();
 }
 
+allocation_statistics workbook::arena_statistics() const
+{
+    allocation_statistics statistics;
+
+    for (const auto &impl : d_->worksheets_)
+    {
+        statistics += impl.arena_.statistics();
+        statistics += impl.cell_map_.statistics();
+    }
+
+    return statistics;
+}
+
 worksheet workbook::operator[](const std::string &name)
 {
     return sheet_by_title(name);
@@ -1078,8 +1076,12 @@ worksheet workbook::operator[](std::size_t index)
 
 void workbook::clear()
 {
+    const auto thread_count = d_->thread_count_;
+    const auto compression_block_size = d_->compression_block_size_;
     *d_ = detail::workbook_impl();
     d_->stylesheet_.clear();
+    d_->thread_count_ = thread_count;
+    d_->compression_block_size_ = compression_block_size;
 }
 
 bool workbook::operator==(const workbook &rhs) const
@@ -1211,21 +1213,47 @@ void workbook::clear_formats()
 
 void workbook::apply_to_cells(std::function<void(cell)> f)
 {
-    for (auto ws : *this)
+    for (auto &ws : d_->worksheets_)
     {
-        for (auto row = ws.lowest_row(); row <= ws.highest_row(); ++row)
+        for (auto c : stored_cells(ws))
         {
-            for (auto column = ws.lowest_column(); column <= ws.highest_column(); ++column)
-            {
-                if (ws.has_cell(cell_reference(column, row)))
-                {
-                    f.operator()(ws.cell(cell_reference(column, row)));
-                }
-            }
+            f(cell(c));
         }
     }
 }
 
+void workbook::parallel_apply_to_cells(std::function<void(cell)> f, std::size_t thread_count)
+{
+    std::vector<detail::cell_impl *> cells;
+
+    for (auto &ws : d_->worksheets_)
+    {
+        const auto sheet_cells = stored_cells(ws);
+        cells.insert(cells.end(), sheet_cells.begin(), sheet_cells.end());
+    }
+
+    // each row starts at one of these offsets in cells and ends at the next
+    std::vector<std::size_t> row_starts;
+
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+        if (i == 0 || cells[i]->row_ != cells[i - 1]->row_ || cells[i]->parent_ != cells[i - 1]->parent_)
+        {
+            row_starts.push_back(i);
+        }
+    }
+
+    row_starts.push_back(cells.size());
+
+    // the rows of every worksheet are shared out in one go so the threads are started once per call
+    detail::parallel_for(row_starts.size() - 1, thread_count, [&](std::size_t row) {
+        for (auto i = row_starts[row]; i < row_starts[row + 1]; ++i)
+        {
+            f(cell(cells[i]));
+        }
+    });
+}
+
 format workbook::format(std::size_t format_index)
 {
     return d_->stylesheet_.get().format(format_index);
@@ -1246,49 +1274,47 @@ const manifest &workbook::manifest() const
     return d_->manifest_;
 }
 
-std::vector<rich_text> &workbook::shared_strings()
+std::vector<rich_text> workbook::shared_strings() const
 {
-    return d_->shared_strings_;
+    std::vector<rich_text> strings;
+    strings.reserve(d_->shared_strings_.size());
+
+    for (std::size_t i = 0; i < d_->shared_strings_.size(); ++i)
+    {
+        strings.push_back(d_->shared_strings_.at(i));
+    }
+
+    return strings;
 }
 
-const std::vector<rich_text> &workbook::shared_strings() const
+rich_text workbook::shared_string(std::size_t index) const
 {
-    return d_->shared_strings_;
+    return d_->shared_strings_.at(index);
 }
 
-std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_duplicates)
+string_view workbook::shared_string_text(std::size_t index) const
 {
-    register_workbook_part(relationship_type::shared_string_table);
+    return d_->shared_strings_.text(index);
+}
 
-    auto index = std::size_t(0);
+std::size_t workbook::shared_string_count() const
+{
+    return d_->shared_strings_.size();
+}
 
-    if (!allow_duplicates)
+std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_duplicates)
+{
+    if (d_->shared_strings_.empty())
     {
-        // TODO: inefficient, use a set or something?
-        for (auto &s : d_->shared_strings_)
-        {
-            if (s == shared)
-            {
-                return index;
-            }
-
-            ++index;
-        }
+        register_workbook_part(relationship_type::shared_string_table);
     }
 
-    d_->shared_strings_.push_back(shared);
-
-    return index;
+    return d_->shared_strings_.add(shared, allow_duplicates);
 }
 
 bool workbook::contains(const std::string &sheet_title) const
 {
-    for (auto ws : *this)
-    {
-        if (ws.title() == sheet_title) return true;
-    }
-
-    return false;
+    return d_->find_sheet(sheet_title) != nullptr;
 }
 
 void workbook::thumbnail(const std::vector<std::uint8_t> &thumbnail,
@@ -1341,6 +1367,26 @@ void workbook::base_date(calendar base_date)
     d_->base_date_ = base_date;
 }
 
+std::size_t workbook::thread_count() const
+{
+    return d_->thread_count_;
+}
+
+void workbook::thread_count(std::size_t count)
+{
+    d_->thread_count_ = count;
+}
+
+std::size_t workbook::compression_block_size() const
+{
+    return d_->compression_block_size_;
+}
+
+void workbook::compression_block_size(std::size_t size)
+{
+    d_->compression_block_size_ = size;
+}
+
 bool workbook::has_title() const
 {
     return d_->title_.is_set();
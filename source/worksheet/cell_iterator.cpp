@@ -21,11 +21,185 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/major_order.hpp>
 
+namespace {
+
+/// <summary>
+/// Moves cursor to the next cell of bounds, or one past the end if there is none.
+/// When skipping null cells, the cell store is asked for the next stored cell
+/// directly so empty stretches of the range cost nothing.
+/// </summary>
+void advance(const xlnt::detail::cell_store &cells, xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order, bool skip_null, bool wrap)
+{
+    const auto first_column = bounds.top_left().column_index();
+    const auto last_column = bounds.bottom_right().column_index();
+    const auto first_row = bounds.top_left().row();
+    const auto last_row = bounds.bottom_right().row();
+
+    if (order == xlnt::major_order::row)
+    {
+        if (cursor.column_index() > last_column)
+        {
+            return;
+        }
+
+        cursor.column_index(cursor.column_index() + 1);
+
+        if (wrap && cursor.column_index() > last_column && cursor.row() < last_row)
+        {
+            cursor.row(cursor.row() + 1);
+            cursor.column_index(first_column);
+        }
+
+        if (!skip_null || cursor.column_index() > last_column)
+        {
+            return;
+        }
+
+        auto column = cells.next_column(cursor.row(), cursor.column_index(), last_column);
+
+        if (column == 0 && wrap && cursor.row() < last_row)
+        {
+            const auto row = cells.next_row(cursor.row() + 1, last_row, first_column, last_column);
+
+            if (row != 0)
+            {
+                cursor.row(row);
+                column = cells.next_column(row, first_column, last_column);
+            }
+            else
+            {
+                cursor.row(last_row);
+            }
+        }
+
+        cursor.column_index(column != 0 ? column : last_column + 1);
+    }
+    else
+    {
+        if (cursor.row() > last_row)
+        {
+            return;
+        }
+
+        cursor.row(cursor.row() + 1);
+
+        if (wrap && cursor.row() > last_row && cursor.column_index() < last_column)
+        {
+            cursor.column_index(cursor.column_index() + 1);
+            cursor.row(first_row);
+        }
+
+        if (!skip_null || cursor.row() > last_row)
+        {
+            return;
+        }
+
+        auto row = cells.next_row(cursor.row(), last_row, cursor.column_index(), cursor.column_index());
+
+        while (row == 0 && wrap && cursor.column_index() < last_column)
+        {
+            cursor.column_index(cursor.column_index() + 1);
+            row = cells.next_row(first_row, last_row, cursor.column_index(), cursor.column_index());
+        }
+
+        cursor.row(row != 0 ? row : last_row + 1);
+    }
+}
+
+/// <summary>
+/// Moves cursor to the previous cell of bounds. The cursor never moves before
+/// the first cell of bounds, even if that cell is null and null cells are skipped.
+/// </summary>
+void retreat(const xlnt::detail::cell_store &cells, xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order, bool skip_null, bool wrap)
+{
+    const auto first_column = bounds.top_left().column_index();
+    const auto last_column = bounds.bottom_right().column_index();
+    const auto first_row = bounds.top_left().row();
+    const auto last_row = bounds.bottom_right().row();
+
+    if (order == xlnt::major_order::row)
+    {
+        if (cursor.column_index() > first_column)
+        {
+            cursor.column_index(cursor.column_index() - 1);
+        }
+        else if (wrap && cursor.row() > first_row)
+        {
+            cursor.row(cursor.row() - 1);
+            cursor.column_index(last_column);
+        }
+        else
+        {
+            return;
+        }
+
+        if (!skip_null)
+        {
+            return;
+        }
+
+        auto column = cells.previous_column(cursor.row(), first_column, cursor.column_index());
+
+        if (column == 0 && wrap && cursor.row() > first_row)
+        {
+            const auto row = cells.previous_row(first_row, cursor.row() - 1, first_column, last_column);
+
+            if (row != 0)
+            {
+                cursor.row(row);
+                column = cells.previous_column(row, first_column, last_column);
+            }
+            else
+            {
+                cursor.row(first_row);
+            }
+        }
+
+        cursor.column_index(column != 0 ? column : first_column);
+    }
+    else
+    {
+        if (cursor.row() > first_row)
+        {
+            cursor.row(cursor.row() - 1);
+        }
+        else if (wrap && cursor.column_index() > first_column)
+        {
+            cursor.column_index(cursor.column_index() - 1);
+            cursor.row(last_row);
+        }
+        else
+        {
+            return;
+        }
+
+        if (!skip_null)
+        {
+            return;
+        }
+
+        auto row = cells.previous_row(first_row, cursor.row(), cursor.column_index(), cursor.column_index());
+
+        while (row == 0 && wrap && cursor.column_index() > first_column)
+        {
+            cursor.column_index(cursor.column_index() - 1);
+            row = cells.previous_row(first_row, last_row, cursor.column_index(), cursor.column_index());
+        }
+
+        cursor.row(row != 0 ? row : first_row);
+    }
+}
+
+} // namespace
+
 namespace xlnt {
 
 cell_iterator::cell_iterator(worksheet ws, const cell_reference &cursor,
@@ -100,36 +274,7 @@ bool const_cell_iterator::operator!=(const const_cell_iterator &other) const
 
 cell_iterator &cell_iterator::operator--()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() > bounds_.top_left().column())
-        {
-            cursor_.column_index(cursor_.column_index() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() > bounds_.top_left().row())
-        {
-            cursor_.row(cursor_.row() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
-    }
+    retreat(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
@@ -137,36 +282,7 @@ cell_iterator &cell_iterator::operator--()
 
 const_cell_iterator &const_cell_iterator::operator--()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() > bounds_.top_left().column())
-        {
-            cursor_.column_index(cursor_.column_index() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() > bounds_.top_left().row())
-        {
-            cursor_.row(cursor_.row() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
-    }
+    retreat(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
@@ -189,73 +305,15 @@ const_cell_iterator const_cell_iterator::operator--(int)
 
 cell_iterator &cell_iterator::operator++()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() <= bounds_.bottom_right().column())
-        {
-            cursor_.column_index(cursor_.column_index() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() <= bounds_.bottom_right().row())
-        {
-            cursor_.row(cursor_.row() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
-    }
+    advance(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
 
 const_cell_iterator &const_cell_iterator::operator++()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() <= bounds_.bottom_right().column())
-        {
-            cursor_.column_index(cursor_.column_index() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() <= bounds_.bottom_right().row())
-        {
-            cursor_.row(cursor_.row() + 1);
-        }
+    advance(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
-    }
-    
     return *this;
 }
 
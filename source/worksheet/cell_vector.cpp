@@ -47,8 +47,9 @@ cell_vector::iterator cell_vector::begin()
 
 cell_vector::iterator cell_vector::end()
 {
-    auto past_end = cursor_;
-    
+    // a wrapping vector ends after the last cell of bounds rather than of its first vector
+    auto past_end = wrap_ ? bounds_.bottom_right() : cursor_;
+
     if (order_ == major_order::row)
     {
         past_end.column_index(bounds_.bottom_right().column_index() + 1);
@@ -68,8 +69,9 @@ cell_vector::const_iterator cell_vector::cbegin() const
 
 cell_vector::const_iterator cell_vector::cend() const
 {
-    auto past_end = cursor_;
-    
+    // a wrapping vector ends after the last cell of bounds rather than of its first vector
+    auto past_end = wrap_ ? bounds_.bottom_right() : cursor_;
+
     if (order_ == major_order::row)
     {
         past_end.column_index(bounds_.bottom_right().column_index() + 1);
@@ -109,6 +111,11 @@ const cell cell_vector::back() const
 
 std::size_t cell_vector::length() const
 {
+    if (wrap_)
+    {
+        return (bounds_.width() + 1) * (bounds_.height() + 1);
+    }
+
     return order_ == major_order::row ? bounds_.width() + 1 : bounds_.height() + 1;
 }
 
@@ -153,6 +160,18 @@ cell_vector::const_reverse_iterator cell_vector::rend() const
 
 cell cell_vector::operator[](std::size_t cell_index)
 {
+    if (wrap_)
+    {
+        const auto width = bounds_.width() + 1;
+        const auto height = bounds_.height() + 1;
+        const auto major = static_cast<int>(cell_index / (order_ == major_order::row ? width : height));
+        const auto minor = static_cast<int>(cell_index % (order_ == major_order::row ? width : height));
+
+        return order_ == major_order::row
+            ? ws_.cell(bounds_.top_left().make_offset(minor, major))
+            : ws_.cell(bounds_.top_left().make_offset(major, minor));
+    }
+
     if (order_ == major_order::row)
     {
         return ws_.cell(cursor_.make_offset(static_cast<int>(cell_index), 0));
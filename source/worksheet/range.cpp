@@ -21,6 +21,10 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <unordered_map>
+
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/stylesheet.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/style.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -96,43 +100,43 @@ bool range::contains(const cell_reference &ref)
 
 range range::alignment(const xlnt::alignment &new_alignment)
 {
-    apply([&new_alignment](class cell c) { c.alignment(new_alignment); });
+    restyle([&new_alignment](class format f) { return f.alignment(new_alignment, true); });
     return *this;
 }
 
 range range::border(const xlnt::border &new_border)
 {
-    apply([&new_border](class cell c) { c.border(new_border); });
+    restyle([&new_border](class format f) { return f.border(new_border, true); });
     return *this;
 }
 
 range range::fill(const xlnt::fill &new_fill)
 {
-    apply([&new_fill](class cell c) { c.fill(new_fill); });
+    restyle([&new_fill](class format f) { return f.fill(new_fill, true); });
     return *this;
 }
 
 range range::font(const xlnt::font &new_font)
 {
-    apply([&new_font](class cell c) { c.font(new_font); });
+    restyle([&new_font](class format f) { return f.font(new_font, true); });
     return *this;
 }
 
 range range::number_format(const xlnt::number_format &new_number_format)
 {
-    apply([&new_number_format](class cell c) { c.number_format(new_number_format); });
+    restyle([&new_number_format](class format f) { return f.number_format(new_number_format, true); });
     return *this;
 }
 
 range range::protection(const xlnt::protection &new_protection)
 {
-    apply([&new_protection](class cell c) { c.protection(new_protection); });
+    restyle([&new_protection](class format f) { return f.protection(new_protection, true); });
     return *this;
 }
 
 range range::style(const class style &new_style)
 {
-    apply([&new_style](class cell c) { c.style(new_style); });
+    restyle([&new_style](class format f) { return f.style(new_style); });
     return *this;
 }
 
@@ -157,6 +161,45 @@ void range::apply(std::function<void(class cell)> f)
     }
 }
 
+void range::restyle(std::function<class format(class format)> change)
+{
+    // results by the format they were made from, where unformatted cells use nullptr
+    std::unordered_map<detail::format_impl *, class format> restyled;
+
+    for (auto row : *this)
+    {
+        for (auto cell : row)
+        {
+            const auto source = cell.d_->format_;
+            const auto match = restyled.find(source);
+
+            if (match != restyled.end())
+            {
+                cell.format(match->second);
+                continue;
+            }
+
+            // the source is pinned until the end so its address can't be reused by a new format
+            if (source != nullptr)
+            {
+                source->parent->retain(*source);
+            }
+
+            const auto result = change(source != nullptr ? cell.modifiable_format() : ws_.workbook().create_format());
+            restyled.emplace(source, result);
+            cell.restyle(result);
+        }
+    }
+
+    for (const auto &source_result : restyled)
+    {
+        if (source_result.first != nullptr)
+        {
+            source_result.first->parent->release(*source_result.first);
+        }
+    }
+}
+
 cell range::cell(const cell_reference &ref)
 {
     return (*this)[ref.row() - 1][ref.column().index - 1];
@@ -21,11 +21,119 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 #include <xlnt/cell/cell.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
+namespace {
+
+/// <summary>
+/// Returns true if the row (or column in column-major order) of bounds at cursor
+/// contains no cells. This asks the cell store directly rather than walking a
+/// cell_vector so it never probes empty coordinates one by one.
+/// </summary>
+bool is_empty_vector(const xlnt::detail::cell_store &cells, const xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order)
+{
+    if (order == xlnt::major_order::row)
+    {
+        return !cells.has_cell_in_row(cursor.row(),
+            bounds.top_left().column_index(), bounds.bottom_right().column_index());
+    }
+
+    return !cells.has_cell_in_column(cursor.column_index(),
+        bounds.top_left().row(), bounds.bottom_right().row());
+}
+
+/// <summary>
+/// Moves cursor to the next row (or column in column-major order) of bounds, or one
+/// past the end if there is none. Empty rows are skipped by asking the cell store for
+/// the next populated row so runs of empty rows cost nothing.
+/// </summary>
+void advance(const xlnt::detail::cell_store &cells, xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order, bool skip_null)
+{
+    if (order == xlnt::major_order::row)
+    {
+        const auto last = bounds.bottom_right().row();
+
+        if (cursor.row() <= last)
+        {
+            cursor.row(cursor.row() + 1);
+        }
+
+        if (skip_null && cursor.row() <= last)
+        {
+            const auto row = cells.next_row(cursor.row(), last,
+                bounds.top_left().column_index(), bounds.bottom_right().column_index());
+            cursor.row(row != 0 ? row : last + 1);
+        }
+    }
+    else
+    {
+        const auto last = bounds.bottom_right().column_index();
+
+        if (cursor.column_index() <= last)
+        {
+            cursor.column_index(cursor.column_index() + 1);
+        }
+
+        if (skip_null)
+        {
+            while (cursor.column_index() <= last && is_empty_vector(cells, cursor, bounds, order))
+            {
+                cursor.column_index(cursor.column_index() + 1);
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Moves cursor to the previous row (or column in column-major order) of bounds. The
+/// cursor never moves before the first row of bounds, even if it is empty.
+/// </summary>
+void retreat(const xlnt::detail::cell_store &cells, xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order, bool skip_null)
+{
+    if (order == xlnt::major_order::row)
+    {
+        const auto first = bounds.top_left().row();
+
+        if (cursor.row() > first)
+        {
+            cursor.row(cursor.row() - 1);
+        }
+
+        if (skip_null)
+        {
+            const auto row = cells.previous_row(first, cursor.row(),
+                bounds.top_left().column_index(), bounds.bottom_right().column_index());
+            cursor.row(row != 0 ? row : first);
+        }
+    }
+    else
+    {
+        const auto first = bounds.top_left().column_index();
+
+        if (cursor.column_index() > first)
+        {
+            cursor.column_index(cursor.column_index() - 1);
+        }
+
+        if (skip_null)
+        {
+            while (cursor.column_index() > first && is_empty_vector(cells, cursor, bounds, order))
+            {
+                cursor.column_index(cursor.column_index() - 1);
+            }
+        }
+    }
+}
+
+} // namespace
+
 namespace xlnt {
 
 cell_vector range_iterator::operator*() const
@@ -41,7 +149,7 @@ range_iterator::range_iterator(worksheet &ws, const cell_reference &cursor,
       order_(order),
       skip_null_(skip_null)
 {
-    if (skip_null_ && (**this).empty())
+    if (skip_null_ && is_empty_vector(ws_.d_->cell_map_, cursor_, bounds_, order_))
     {
         ++(*this);
     }
@@ -67,36 +175,7 @@ bool range_iterator::operator!=(const range_iterator &other) const
 
 range_iterator &range_iterator::operator--()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.row() > bounds_.top_left().row())
-        {
-            cursor_.row(cursor_.row() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.column() > bounds_.top_left().column())
-        {
-            cursor_.column_index(cursor_.column_index() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
-    }
+    retreat(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_);
 
     return *this;
 }
@@ -111,36 +190,7 @@ range_iterator range_iterator::operator--(int)
 
 range_iterator &range_iterator::operator++()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.row() <= bounds_.bottom_right().row())
-        {
-            cursor_.row(cursor_.row() + 1);
-        }
-    
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.column() <= bounds_.bottom_right().column())
-        {
-            cursor_.column_index(cursor_.column_index() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
-    }
+    advance(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_);
 
     return *this;
 }
@@ -162,7 +212,7 @@ const_range_iterator::const_range_iterator(const worksheet &ws, const cell_refer
       order_(order),
       skip_null_(skip_null)
 {
-    if (skip_null_ && (**this).empty())
+    if (skip_null_ && is_empty_vector(ws_->cell_map_, cursor_, bounds_, order_))
     {
         ++(*this);
     }
@@ -188,36 +238,7 @@ bool const_range_iterator::operator!=(const const_range_iterator &other) const
 
 const_range_iterator &const_range_iterator::operator--()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.row() > bounds_.top_left().row())
-        {
-            cursor_.row(cursor_.row() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.column() > bounds_.top_left().column())
-        {
-            cursor_.column_index(cursor_.column_index() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
-    }
+    retreat(ws_->cell_map_, cursor_, bounds_, order_, skip_null_);
 
     return *this;
 }
@@ -232,36 +253,7 @@ const_range_iterator const_range_iterator::operator--(int)
 
 const_range_iterator &const_range_iterator::operator++()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.row() <= bounds_.bottom_right().row())
-        {
-            cursor_.row(cursor_.row() + 1);
-        }
-    
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.column() <= bounds_.bottom_right().column())
-        {
-            cursor_.column_index(cursor_.column_index() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while ((**this).empty() && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
-    }
+    advance(ws_->cell_map_, cursor_, bounds_, order_, skip_null_);
 
     return *this;
 }
@@ -34,13 +34,16 @@
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/packaging/relationship.hpp>
+#include <xlnt/utils/allocation_statistics.hpp>
 #include <xlnt/utils/date.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/string_view.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/worksheet_iterator.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
+#include <xlnt/worksheet/column_data.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
@@ -56,6 +59,41 @@ int points_to_pixels(double points, double dpi)
     return static_cast<int>(std::ceil(points * dpi / 72));
 }
 
+bool is_numeric(xlnt::cell_type type)
+{
+    return type == xlnt::cell_type::number || type == xlnt::cell_type::boolean;
+}
+
+/// <summary>
+/// Returns the plain text of cell if it holds a string or an error, or an empty string.
+/// </summary>
+std::string plain_text(const xlnt::detail::worksheet_impl &ws, const xlnt::detail::cell_impl &cell)
+{
+    if (cell.type_ == xlnt::cell_type::shared_string)
+    {
+        return ws.parent_->shared_string_text(static_cast<std::size_t>(cell.value_numeric_)).to_string();
+    }
+
+    auto match = ws.cell_text_.find(cell.key());
+
+    return match == ws.cell_text_.end() ? std::string() : match->second.plain_text();
+}
+
+/// <summary>
+/// Returns the number of rows from first_row to last_row, or 0 if last_row comes
+/// first. Throws invalid_parameter if either row is outside of the sheet.
+/// </summary>
+std::size_t row_count(xlnt::row_t first_row, xlnt::row_t last_row)
+{
+    if (first_row < xlnt::constants::min_row() || first_row > xlnt::constants::max_row()
+        || last_row < xlnt::constants::min_row() || last_row > xlnt::constants::max_row())
+    {
+        throw xlnt::invalid_parameter();
+    }
+
+    return first_row > last_row ? 0 : static_cast<std::size_t>(last_row - first_row) + 1;
+}
+
 } // namespace
 
 namespace xlnt {
@@ -198,33 +236,18 @@ const workbook &worksheet::workbook() const
 
 void worksheet::garbage_collect()
 {
-    auto cell_map_iter = d_->cell_map_.begin();
-
-    while (cell_map_iter != d_->cell_map_.end())
-    {
-        auto cell_iter = cell_map_iter->second.begin();
+    auto ws = d_;
 
-        while (cell_iter != cell_map_iter->second.end())
+    d_->cell_map_.erase_if([ws](detail::cell_impl &impl) {
+        if (!xlnt::cell(&impl).garbage_collectible())
         {
-            class cell current_cell(&cell_iter->second);
-
-            if (current_cell.garbage_collectible())
-            {
-                cell_iter = cell_map_iter->second.erase(cell_iter);
-                continue;
-            }
-
-            cell_iter++;
+            return false;
         }
 
-        if (cell_map_iter->second.empty())
-        {
-            cell_map_iter = d_->cell_map_.erase(cell_map_iter);
-            continue;
-        }
+        ws->erase_cell_attributes(impl.key());
 
-        cell_map_iter++;
-    }
+        return true;
+    });
 }
 
 void worksheet::id(std::size_t id)
@@ -254,17 +277,16 @@ void worksheet::title(const std::string &title)
         throw invalid_sheet_title(title);
     }
 
-    auto same_title = std::find_if(workbook().begin(), workbook().end(),
-        [&](worksheet ws) { return ws.title() == title; });
+    auto same_title = workbook().d_->find_sheet(title);
 
-    if (same_title != workbook().end() && *same_title != *this)
+    if (same_title != nullptr && same_title != d_)
     {
         throw invalid_sheet_title(title);
     }
 
     workbook().d_->sheet_title_rel_id_map_[title] = workbook().d_->sheet_title_rel_id_map_[d_->title_];
     workbook().d_->sheet_title_rel_id_map_.erase(d_->title_);
-    d_->title_ = title;
+    workbook().d_->rename_sheet(*d_, title);
 
     workbook().update_sheet_properties();
 }
@@ -354,32 +376,40 @@ void worksheet::unfreeze_panes()
 
 cell worksheet::cell(const cell_reference &reference)
 {
-    if (d_->cell_map_.find(reference.row()) == d_->cell_map_.end())
-    {
-        d_->cell_map_[reference.row()] = std::unordered_map<column_t, detail::cell_impl>();
-    }
-
-    auto &row = d_->cell_map_[reference.row()];
+    auto impl = d_->cell_map_.find(reference.row(), reference.column_index());
 
-    if (row.find(reference.column_index()) == row.end())
+    if (impl == nullptr)
     {
-        auto &impl = row[reference.column_index()] = detail::cell_impl();
-        impl.parent_ = d_;
-        impl.column_ = reference.column_index();
-        impl.row_ = reference.row();
+        impl = d_->cell_map_.create(reference.row(), reference.column_index());
     }
 
-    return xlnt::cell(&row[reference.column_index()]);
+    return xlnt::cell(impl);
 }
 
 const cell worksheet::cell(const cell_reference &reference) const
 {
-    return xlnt::cell(&d_->cell_map_.at(reference.row()).at(reference.column_index()));
+    auto impl = d_->cell_map_.find(reference.row(), reference.column_index());
+
+    if (impl == nullptr)
+    {
+        throw key_not_found();
+    }
+
+    return xlnt::cell(impl);
 }
 
 cell worksheet::cell(xlnt::column_t column, row_t row)
 {
-    return cell(cell_reference(column, row));
+    // the same check as cell_reference's, without building one
+    if (row < constants::min_row() || row > constants::max_row()
+        || column < constants::min_column() || column > constants::max_column())
+    {
+        throw invalid_cell_reference(column, row);
+    }
+
+    auto impl = d_->cell_map_.create(row, column.index);
+
+    return xlnt::cell(impl);
 }
 
 const cell worksheet::cell(xlnt::column_t column, row_t row) const
@@ -387,15 +417,76 @@ const cell worksheet::cell(xlnt::column_t column, row_t row) const
     return cell(cell_reference(column, row));
 }
 
-bool worksheet::has_cell(const cell_reference &reference) const
+void worksheet::reserve_row(row_t row, column_t first_column, std::size_t count)
+{
+    if (row < constants::min_row() || row > constants::max_row()
+        || first_column < constants::min_column() || first_column > constants::max_column()
+        || count > static_cast<std::size_t>(constants::max_column().index - first_column.index + 1))
+    {
+        throw invalid_parameter();
+    }
+
+    if (count > 0)
+    {
+        d_->cell_map_.reserve_row(row, count);
+    }
+}
+
+void worksheet::write_row(row_t row, const double *values, std::size_t count, column_t first_column)
+{
+    reserve_row(row, first_column, count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto impl = d_->cell_map_.create(row, first_column.index + static_cast<column_t::index_t>(i));
+        xlnt::cell(impl).value(values[i]);
+    }
+}
+
+void worksheet::write_row(row_t row, const std::vector<double> &values, column_t first_column)
+{
+    write_row(row, values.data(), values.size(), first_column);
+}
+
+void worksheet::write_row(row_t row, const std::vector<std::string> &values, column_t first_column)
+{
+    reserve_row(row, first_column, values.size());
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        auto impl = d_->cell_map_.create(row, first_column.index + static_cast<column_t::index_t>(i));
+        xlnt::cell(impl).value(values[i]);
+    }
+}
+
+void worksheet::write_block(const cell_reference &top_left, const double *values, std::size_t rows, std::size_t columns)
 {
-    const auto row = d_->cell_map_.find(reference.row());
-    if (row == d_->cell_map_.cend()) return false;
+    if (rows > static_cast<std::size_t>(constants::max_row() - top_left.row() + 1))
+    {
+        throw invalid_parameter();
+    }
 
-    const auto col = row->second.find(reference.column_index());
-    if (col == row->second.cend()) return false;
+    d_->cell_map_.reserve(top_left.row() + rows);
+
+    // cells are created row by row, in storage order, although values is column-major
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        const auto row = top_left.row() + static_cast<row_t>(r);
+        reserve_row(row, top_left.column(), columns);
+
+        for (std::size_t c = 0; c < columns; ++c)
+        {
+            auto impl = d_->cell_map_.create(row, top_left.column_index() + static_cast<column_t::index_t>(c));
+            xlnt::cell(impl).value(values[c * rows + r]);
+        }
+    }
+}
+
+bool worksheet::has_cell(const cell_reference &reference) const
+{
+    const auto &cells = d_->cell_map_;
 
-    return true;
+    return cells.find(reference.row(), reference.column_index()) != nullptr;
 }
 
 bool worksheet::has_row_properties(row_t row) const
@@ -440,17 +531,7 @@ column_t worksheet::lowest_column() const
         return constants::min_column();
     }
 
-    column_t lowest = constants::max_column();
-
-    for (auto &row : d_->cell_map_)
-    {
-        for (auto &c : row.second)
-        {
-            lowest = std::min(lowest, c.first);
-        }
-    }
-
-    return lowest;
+    return d_->cell_map_.first_column();
 }
 
 row_t worksheet::lowest_row() const
@@ -460,41 +541,27 @@ row_t worksheet::lowest_row() const
         return constants::min_row();
     }
 
-    row_t lowest = constants::max_row();
-
-    for (auto &row : d_->cell_map_)
-    {
-        lowest = std::min(lowest, row.first);
-    }
-
-    return lowest;
+    return d_->cell_map_.first_row();
 }
 
 row_t worksheet::highest_row() const
 {
-    row_t highest = constants::min_row();
-
-    for (auto &row : d_->cell_map_)
+    if (d_->cell_map_.empty())
     {
-        highest = std::max(highest, row.first);
+        return constants::min_row();
     }
 
-    return highest;
+    return d_->cell_map_.last_row();
 }
 
 column_t worksheet::highest_column() const
 {
-    column_t highest = constants::min_column();
-
-    for (auto &row : d_->cell_map_)
+    if (d_->cell_map_.empty())
     {
-        for (auto &c : row.second)
-        {
-            highest = std::max(highest, c.first);
-        }
+        return constants::min_column();
     }
 
-    return highest;
+    return d_->cell_map_.last_column();
 }
 
 range_reference worksheet::calculate_dimension() const
@@ -594,7 +661,7 @@ row_t worksheet::next_row() const
 {
     auto row = highest_row() + 1;
 
-    if (row == 2 && d_->cell_map_.size() == 0)
+    if (row == 2 && d_->cell_map_.empty())
     {
         row = 1;
     }
@@ -622,9 +689,6 @@ const xlnt::range worksheet::columns(bool skip_null) const
     return xlnt::range(*this, calculate_dimension(), major_order::column, skip_null);
 }
 
-/*
-//TODO: finish implementing cell_iterator wrapping before uncommenting
-
 cell_vector worksheet::cells(bool skip_null)
 {
     const auto dimension = calculate_dimension();
@@ -636,7 +700,6 @@ const cell_vector worksheet::cells(bool skip_null) const
     const auto dimension = calculate_dimension();
     return cell_vector(*this, dimension.top_left(), dimension, major_order::row, skip_null, true);
 }
-*/
 
 bool worksheet::operator==(const worksheet &other) const
 {
@@ -652,34 +715,30 @@ bool worksheet::compare(const worksheet &other, bool reference) const
 
     if (d_->parent_ != other.d_->parent_) return false;
 
-    for (auto &row : d_->cell_map_)
-    {
-        if (other.d_->cell_map_.find(row.first) == other.d_->cell_map_.end())
-        {
-            return false;
-        }
+    auto cells_match = true;
 
-        for (auto &cell : row.second)
-        {
-            if (other.d_->cell_map_[row.first].find(cell.first) == other.d_->cell_map_[row.first].end())
-            {
-                return false;
-            }
+    const auto &cells = d_->cell_map_;
+    const auto &other_cells = other.d_->cell_map_;
 
-            xlnt::cell this_cell(&cell.second);
-            xlnt::cell other_cell(&other.d_->cell_map_[row.first][cell.first]);
+    cells.for_each([&](const detail::cell_impl &impl) {
+        if (!cells_match) return;
 
-            if (this_cell.data_type() != other_cell.data_type())
-            {
-                return false;
-            }
+        auto other_impl = other_cells.find(impl.row_, impl.column_.index);
 
-            if (this_cell.data_type() == xlnt::cell::type::number
-                && std::fabs(this_cell.value<long double>() - other_cell.value<long double>()) > 0.L)
-            {
-                return false;
-            }
+        if (other_impl == nullptr || impl.type_ != other_impl->type_)
+        {
+            cells_match = false;
         }
+        else if (impl.type_ == xlnt::cell::type::number
+            && std::fabs(impl.value_numeric_ - other_impl->value_numeric_) > 0.0)
+        {
+            cells_match = false;
+        }
+    });
+
+    if (!cells_match)
+    {
+        return false;
     }
 
     // todo: missing some comparisons
@@ -758,6 +817,94 @@ void worksheet::reserve(std::size_t n)
     d_->cell_map_.reserve(n);
 }
 
+std::vector<double> worksheet::read_numbers(column_t column, row_t first_row, row_t last_row) const
+{
+    const auto count = row_count(first_row, last_row);
+
+    if (count == 0)
+    {
+        return {};
+    }
+
+    std::vector<double> numbers(count, std::numeric_limits<double>::quiet_NaN());
+
+    d_->cell_map_.for_each_in_column(column.index, first_row, last_row,
+        [&](row_t row, const detail::cell_impl &cell) {
+            if (is_numeric(cell.type_))
+            {
+                numbers[row - first_row] = cell.value_numeric_;
+            }
+        });
+
+    return numbers;
+}
+
+std::vector<std::string> worksheet::read_strings(column_t column, row_t first_row, row_t last_row) const
+{
+    const auto count = row_count(first_row, last_row);
+
+    if (count == 0)
+    {
+        return {};
+    }
+
+    std::vector<std::string> strings(count);
+
+    d_->cell_map_.for_each_in_column(column.index, first_row, last_row,
+        [&](row_t row, const detail::cell_impl &cell) {
+            if (cell.type_ != cell_type::empty && !is_numeric(cell.type_))
+            {
+                strings[row - first_row] = plain_text(*d_, cell);
+            }
+        });
+
+    return strings;
+}
+
+column_data worksheet::read_column(column_t column, row_t first_row, row_t last_row) const
+{
+    column_data result;
+    result.first_row = first_row;
+
+    const auto count = row_count(first_row, last_row);
+
+    if (count == 0)
+    {
+        return result;
+    }
+
+    result.types.assign(count, cell_type::empty);
+    result.valid.assign(count, false);
+    result.numbers.assign(count, 0.0);
+    result.strings.resize(count);
+
+    d_->cell_map_.for_each_in_column(column.index, first_row, last_row,
+        [&](row_t row, const detail::cell_impl &cell) {
+            const auto index = row - first_row;
+            result.types[index] = cell.type_;
+            result.valid[index] = cell.type_ != cell_type::empty;
+
+            if (is_numeric(cell.type_))
+            {
+                result.numbers[index] = cell.value_numeric_;
+            }
+            else if (cell.type_ != cell_type::empty)
+            {
+                result.strings[index] = plain_text(*d_, cell);
+            }
+        });
+
+    return result;
+}
+
+allocation_statistics worksheet::arena_statistics() const
+{
+    auto statistics = d_->arena_.statistics();
+    statistics += d_->cell_map_.statistics();
+
+    return statistics;
+}
+
 class header_footer worksheet::header_footer() const
 {
     return d_->header_footer_.get();
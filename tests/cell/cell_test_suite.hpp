@@ -66,6 +66,8 @@ public:
         register_test(test_anchor);
         register_test(test_hyperlink);
         register_test(test_comment);
+        register_test(test_copy_comment);
+        register_test(test_copy_between_workbooks);
     }
 
 private:
@@ -85,10 +87,10 @@ private:
         xlnt_assert(cell.value<int>() == 0);
 
         cell.value("0.9999", true);
-        xlnt_assert(cell.value<long double>() == 0.9999L);
+        xlnt_assert(cell.value<double>() == 0.9999);
 
         cell.value("99E-02", true);
-        xlnt_assert(cell.value<long double>() == 0.99L);
+        xlnt_assert(cell.value<double>() == 0.99);
 
         cell.value("4", true);
         xlnt_assert(cell.value<int>() == 4);
@@ -679,4 +681,53 @@ private:
         xlnt_assert(!cell.has_comment());
         xlnt_assert_throws(cell.comment(), xlnt::exception);
     }
+
+    void test_copy_comment()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto other = wb.create_sheet();
+
+        auto source = ws.cell("A1");
+        source.value(1);
+        source.comment(xlnt::comment("comment", "author"));
+
+        auto copy = other.cell("B2");
+        copy.value(source);
+        xlnt_assert(copy.has_comment());
+        xlnt_assert_equals(copy.comment().plain_text(), "comment");
+        xlnt_assert_equals(copy.comment().author(), "author");
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.sheet_by_index(1).cell("B2").comment().plain_text(), "comment");
+
+        // copying a cell without a comment removes the target's comment
+        copy.value(ws.cell("C3"));
+        xlnt_assert(!copy.has_comment());
+        xlnt_assert_throws(copy.comment(), xlnt::exception);
+        xlnt_assert(source.has_comment());
+    }
+
+    void test_copy_between_workbooks()
+    {
+        xlnt::workbook a;
+        a.active_sheet().cell("A1").value("from a");
+
+        xlnt::workbook b;
+        b.active_sheet().cell("A1").value("bbb");
+        b.active_sheet().cell("A2").value("ccc");
+
+        auto copy = b.active_sheet().cell("B1");
+        copy.value(a.active_sheet().cell("A1"));
+        xlnt_assert_equals(copy.value<std::string>(), "from a");
+        xlnt_assert_equals(b.active_sheet().cell("A1").value<std::string>(), "bbb");
+
+        // copying within a workbook keeps using the same shared string
+        b.active_sheet().cell("B2").value(b.active_sheet().cell("A2"));
+        xlnt_assert_equals(b.active_sheet().cell("B2").value<std::string>(), "ccc");
+        xlnt_assert_equals(b.shared_strings().size(), 3);
+    }
 };
@@ -36,6 +36,7 @@ public:
         register_test(test_properties);
         register_test(test_comparison);
         register_test(test_two_fills);
+        register_test(test_hash);
     }
 
     void test_properties()
@@ -103,4 +104,18 @@ public:
         xlnt_assert_equals(cell1.fill(), xlnt::fill::solid(xlnt::color::yellow()));
         xlnt_assert_equals(cell2.fill(), xlnt::fill::solid(xlnt::color::green()));
     }
+
+    void test_hash()
+    {
+        std::hash<xlnt::fill> hasher;
+
+        xlnt_assert_equals(hasher(xlnt::fill::solid(xlnt::color::red())),
+            hasher(xlnt::fill::solid(xlnt::color::red())));
+        xlnt_assert_equals(hasher(xlnt::fill::solid(xlnt::rgb_color("ffff0000"))),
+            hasher(xlnt::fill::solid(xlnt::color::red())));
+        xlnt_assert_differs(hasher(xlnt::fill::solid(xlnt::color::red())),
+            hasher(xlnt::fill::solid(xlnt::color::green())));
+        xlnt_assert_equals(hasher(xlnt::fill(xlnt::gradient_fill().degree(90))),
+            hasher(xlnt::fill(xlnt::gradient_fill().degree(90))));
+    }
 };
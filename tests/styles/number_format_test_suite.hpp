@@ -112,6 +112,8 @@ public:
         register_test(test_builtin_format_date_dmyminus);
         register_test(test_builtin_format_date_dmminus);
         register_test(test_builtin_format_date_myminus);
+        register_test(test_compiled_format_reuse);
+        register_test(test_bulk_format);
     }
 
     void test_basic()
@@ -977,4 +979,37 @@ public:
     {
         format_and_test(xlnt::number_format::date_myminus(), {{"5-16", "###########", "1-00", "text"}});
     }
+
+    void test_compiled_format_reuse()
+    {
+        // the parsed format is shared, but the calendar still belongs to each call
+        xlnt::number_format date("yyyy-mm-dd");
+        xlnt_assert_equals(date.format(1, xlnt::calendar::windows_1900), "1900-01-01");
+        xlnt_assert_equals(date.format(1, xlnt::calendar::mac_1904), "1904-01-02");
+        xlnt_assert_equals(date.format(1, xlnt::calendar::windows_1900), "1900-01-01");
+
+        // a format string that fails to parse is not cached and fails every time
+        xlnt::number_format invalid("[$-4002]#,##0.00");
+        xlnt_assert_throws(invalid.format(1.2, xlnt::calendar::windows_1900), std::runtime_error);
+        xlnt_assert_throws(invalid.format(1.2, xlnt::calendar::windows_1900), std::runtime_error);
+    }
+
+    void test_bulk_format()
+    {
+        xlnt::number_format nf("#,##0.00;[Red](#,##0.00)");
+        const long double numbers[] = {1234.5L, -0.25L, 0.L, 1234567.891L};
+
+        std::string buffer = "prefix";
+        std::vector<std::size_t> offsets;
+        nf.format(numbers, 4, xlnt::calendar::windows_1900, buffer, offsets);
+
+        xlnt_assert_equals(buffer, "prefix1,234.50(0.25)0.001,234,567.89");
+        xlnt_assert_equals(offsets, std::vector<std::size_t>({14, 20, 24, 36}));
+
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            const auto begin = i == 0 ? std::size_t(6) : offsets[i - 1];
+            xlnt_assert_equals(buffer.substr(begin, offsets[i] - begin), nf.format(numbers[i], xlnt::calendar::windows_1900));
+        }
+    }
 };
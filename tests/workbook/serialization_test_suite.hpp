@@ -23,8 +23,12 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 
+#include <detail/implementations/shared_formula.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/cryptography/xlsx_crypto_consumer.hpp>
 #include <helpers/temporary_file.hpp>
@@ -60,6 +64,15 @@ public:
         register_test(test_round_trip_rw_encrypted);
         register_test(test_streaming_read);
         register_test(test_streaming_write);
+        register_test(test_shared_formulae);
+        register_test(test_shared_formulae_with_line_ranges);
+        register_test(test_round_trip_doubles);
+        register_test(test_inferred_cell_references);
+        register_test(test_read_unusual_sheet_data);
+        register_test(test_read_inline_strings);
+        register_test(test_parallel_load);
+        register_test(test_parallel_save);
+        register_test(test_block_compression);
     }
 
 	bool workbook_matches_file(xlnt::workbook &wb, const xlnt::path &file)
@@ -503,4 +516,439 @@ public:
         b2.value("should not change");
         c3.value("C3!");
     }
+
+    void test_shared_formulae()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 4; ++row)
+        {
+            const auto r = std::to_string(row);
+            ws.cell(xlnt::cell_reference(1, row)).value(static_cast<int>(row));
+            ws.cell(xlnt::cell_reference(2, row)).formula("=A" + r + "*$A$1");
+            ws.cell(xlnt::cell_reference(3, row)).formula("=IF(A" + r + ">0,\"A1\",LOG10(A" + r + "))&'Q1 A1'!B$1");
+        }
+
+        ws.cell("D1").formula("=SUM(A1:A4)");
+        ws.cell("D2").formula("=SUM(A1:A4)");
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::detail::vector_istreambuf data_buffer(data);
+        std::istream data_stream(&data_buffer);
+        xlnt::detail::izstream archive(data_stream);
+        const auto sheet_xml = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+
+        xlnt_assert(sheet_xml.find("t=\"shared\" ref=\"B1:B4\"") != std::string::npos);
+        xlnt_assert(sheet_xml.find("t=\"shared\" ref=\"C1:C4\"") != std::string::npos);
+        xlnt_assert(sheet_xml.find("A2*$A$1") == std::string::npos);
+        xlnt_assert(sheet_xml.find("SUM(A1:A4)") != std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 4; ++row)
+        {
+            const auto r = std::to_string(row);
+            xlnt_assert(loaded_ws.cell(xlnt::cell_reference(2, row)).has_formula());
+            xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(2, row)).formula(), "A" + r + "*$A$1");
+            xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(3, row)).formula(),
+                "IF(A" + r + ">0,\"A1\",LOG10(A" + r + "))&'Q1 A1'!B$1");
+        }
+
+        xlnt_assert_equals(loaded_ws.cell("D2").formula(), "SUM(A1:A4)");
+
+        // replacing a member's formula detaches it from its group
+        loaded_ws.cell("B3").formula("=1+1");
+        xlnt_assert_equals(loaded_ws.cell("B3").formula(), "1+1");
+        xlnt_assert_equals(loaded_ws.cell("B4").formula(), "A4*$A$1");
+        loaded_ws.cell("B2").clear_formula();
+        xlnt_assert(!loaded_ws.cell("B2").has_formula());
+
+        // copies of a member keep the formula it expands to
+        loaded_ws.cell("E1").value(loaded_ws.cell("C2"));
+        xlnt_assert_equals(loaded_ws.cell("E1").formula(), "IF(A2>0,\"A1\",LOG10(A2))&'Q1 A1'!B$1");
+    }
+
+    void test_shared_formulae_with_line_ranges()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 4; ++row)
+        {
+            const auto r = std::to_string(row);
+            ws.cell(xlnt::cell_reference(1, row)).value(static_cast<int>(row));
+            ws.cell(xlnt::cell_reference(5, row)).formula("=SUM(" + r + ":" + r + ")");
+            ws.cell(xlnt::cell_reference(6, row)).formula("=SUM(1:1)");
+            ws.cell(xlnt::cell_reference(7, row)).formula("=SUM(A:A)+SUM($B:$C)+SUM($1:$2)");
+        }
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::detail::vector_istreambuf data_buffer(data);
+        std::istream data_stream(&data_buffer);
+        xlnt::detail::izstream archive(data_stream);
+        const auto sheet_xml = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+
+        xlnt_assert(sheet_xml.find("t=\"shared\" ref=\"E1:E4\"") != std::string::npos);
+        xlnt_assert(sheet_xml.find("t=\"shared\" ref=\"F1:F4\"") == std::string::npos);
+        xlnt_assert(sheet_xml.find("t=\"shared\" ref=\"G1:G4\"") != std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 4; ++row)
+        {
+            const auto r = std::to_string(row);
+            xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(5, row)).formula(), "SUM(" + r + ":" + r + ")");
+            xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(6, row)).formula(), "SUM(1:1)");
+            xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(7, row)).formula(), "SUM(A:A)+SUM($B:$C)+SUM($1:$2)");
+        }
+
+        xlnt_assert_equals(xlnt::detail::translate_formula("SUM(B:C)+SUM($2:3)", 1, 1), "SUM(C:D)+SUM($2:4)");
+        xlnt_assert_equals(xlnt::detail::translate_formula("SUM(A:B)+SUM(1:2)", -1, -1), "SUM(#REF!)+SUM(#REF!)");
+    }
+
+    void test_round_trip_doubles()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        std::vector<double> values = {0.1, 1. / 3., -123.456, 3.141592653589793, 1e-7, 2.5e21,
+            5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 1e15 + 0.5};
+        std::uint64_t bits = 0x9e3779b97f4a7c15;
+
+        for (auto i = 0; i < 1000; ++i)
+        {
+            // arbitrary bit patterns cover every exponent, skipping infinities and nans
+            bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+            double value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            if (std::isfinite(value))
+            {
+                values.push_back(value);
+            }
+        }
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            ws.cell(xlnt::cell_reference(1, static_cast<xlnt::row_t>(i + 1))).value(values[i]);
+        }
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::detail::vector_istreambuf data_buffer(data);
+        std::istream data_stream(&data_buffer);
+        xlnt::detail::izstream archive(data_stream);
+        const auto sheet_xml = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+
+        // values are written with the fewest digits that read back exactly
+        xlnt_assert(sheet_xml.find("<v>0.1</v>") != std::string::npos);
+        xlnt_assert(sheet_xml.find("<v>0.3333333333333333</v>") != std::string::npos);
+        xlnt_assert(sheet_xml.find("<v>-123.456</v>") != std::string::npos);
+        xlnt_assert(sheet_xml.find("<v>1E-7</v>") != std::string::npos);
+        xlnt_assert(sheet_xml.find("<v>2.5E21</v>") != std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(1, static_cast<xlnt::row_t>(i + 1))).value<double>(), values[i]);
+        }
+    }
+
+    /// <summary>
+    /// Saves a workbook with one cell, replaces the worksheet's sheetData element with
+    /// sheet_data and loads the result.
+    /// </summary>
+    xlnt::workbook load_with_sheet_data(const std::string &sheet_data)
+    {
+        xlnt::workbook wb;
+        wb.active_sheet().cell("A1").value(0);
+
+        std::vector<std::uint8_t> original;
+        wb.save(original);
+
+        std::vector<std::uint8_t> modified;
+
+        {
+            xlnt::detail::vector_istreambuf original_buffer(original);
+            std::istream original_stream(&original_buffer);
+            xlnt::detail::izstream original_archive(original_stream);
+
+            xlnt::detail::vector_ostreambuf modified_buffer(modified);
+            std::ostream modified_stream(&modified_buffer);
+            xlnt::detail::ozstream modified_archive(modified_stream);
+
+            for (const auto &file : original_archive.files())
+            {
+                auto contents = original_archive.read(file);
+
+                if (file.string() == "xl/worksheets/sheet1.xml")
+                {
+                    const auto begin = contents.find("<sheetData>");
+                    const auto end = contents.find("</sheetData>") + std::string("</sheetData>").size();
+                    contents.replace(begin, end - begin, sheet_data);
+                }
+
+                auto file_buffer = modified_archive.open(file);
+                std::ostream(file_buffer.get()) << contents;
+            }
+        }
+
+        xlnt::workbook loaded;
+        loaded.load(modified);
+
+        return loaded;
+    }
+
+    void test_inferred_cell_references()
+    {
+        // rows and cells may leave out r, taking the position after the previous one
+        auto wb = load_with_sheet_data("<sheetData>"
+            "<row><c><v>1</v></c><c><v>2</v></c></row>"
+            "<row r=\"3\"><c r=\"B3\"><v>3</v></c><c><v>4.5</v></c></row>"
+            "<row><c s=\"0\"><v>-6E-3</v></c></row>"
+            "</sheetData>");
+        auto ws = wb.active_sheet();
+
+        xlnt_assert_equals(ws.cell("A1").value<int>(), 1);
+        xlnt_assert_equals(ws.cell("B1").value<int>(), 2);
+        xlnt_assert_equals(ws.cell("B3").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("C3").value<double>(), 4.5);
+        xlnt_assert_equals(ws.cell("A4").value<double>(), -0.006);
+        xlnt_assert(!ws.has_cell("A3"));
+
+        // references outside of the sheet and values that aren't numbers fail the load
+        xlnt_assert_throws(load_with_sheet_data("<sheetData><row r=\"1\"><c r=\"A0\"><v>1</v></c></row></sheetData>"),
+            xlnt::invalid_cell_reference);
+        xlnt_assert_throws(load_with_sheet_data("<sheetData><row r=\"1\"><c r=\"ZZZZ1\"><v>1</v></c></row></sheetData>"),
+            xlnt::invalid_cell_reference);
+        xlnt_assert_throws(load_with_sheet_data("<sheetData><row r=\"1\"><c r=\"A1\"><v>abc</v></c></row></sheetData>"),
+            std::invalid_argument);
+    }
+
+    void test_read_inline_strings()
+    {
+        // plain inline strings are scanned directly and rich ones go through the XML parser
+        auto wb = load_with_sheet_data("<sheetData><row r=\"1\">"
+            "<c r=\"A1\" t=\"inlineStr\"><is><t>plain</t></is></c>"
+            "<c r=\"B1\" t=\"inlineStr\"><is><r><t>bold</t></r>"
+            "<r><rPr><b/><sz val=\"12\"/></rPr><t xml:space=\"preserve\"> text</t></r></is></c>"
+            "<c r=\"C1\" t=\"inlineStr\"><is><t>pla</t><rPh sb=\"0\" eb=\"1\"><t>x</t></rPh></is></c>"
+            "</row></sheetData>");
+        auto ws = wb.active_sheet();
+
+        xlnt_assert_equals(ws.cell("A1").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "plain");
+        xlnt_assert_equals(ws.cell("B1").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "bold text");
+
+        const auto runs = ws.cell("B1").value<xlnt::rich_text>().runs();
+        xlnt_assert_equals(runs.size(), 2);
+        xlnt_assert(runs[1].second.is_set());
+        xlnt_assert(runs[1].second.get().bold());
+        xlnt_assert_equals(ws.cell("C1").value<std::string>(), "pla");
+    }
+
+    void test_read_unusual_sheet_data()
+    {
+        // markup the sheetData scanner passes on to the XML parser must be read the same
+        auto wb = load_with_sheet_data("<sheetData>\r\n"
+            "<!-- comment between rows -->"
+            "<row r='1' ht = '20' customHeight='1'>"
+            "<c r='A1' t='str'><v>a &amp; b&#x20;&#9731;\r\nc</v></c>"
+            "<c r='B1' t='str'><v><![CDATA[<tag>]]></v></c>"
+            "<c r='C1'><!-- comment in a cell --><v>2</v></c>"
+            "<c r='D1' s='0'/>"
+            "<c r='E1'><f>C1+1</f><v>3</v></c>"
+            "<c r='F1' t='b'><v>1</v></c>"
+            "</row>"
+            "<row r='2' hidden='1'/>"
+            "</sheetData>");
+        auto ws = wb.active_sheet();
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "a & b \xe2\x98\x83\nc");
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "<tag>");
+        xlnt_assert_equals(ws.cell("C1").value<int>(), 2);
+        xlnt_assert(ws.has_cell("D1"));
+        xlnt_assert(!ws.cell("D1").has_value());
+        xlnt_assert_equals(ws.cell("E1").formula(), "C1+1");
+        xlnt_assert_equals(ws.cell("E1").value<int>(), 3);
+        xlnt_assert(ws.cell("F1").value<bool>());
+        xlnt_assert_equals(ws.row_properties(1).height.get(), 20.0);
+        xlnt_assert(ws.row_properties(1).custom_height);
+        xlnt_assert(ws.row_properties(2).hidden);
+    }
+
+    void test_parallel_load()
+    {
+        xlnt::workbook original;
+        original.active_sheet().title("Sheet0");
+        const auto bold = xlnt::font().bold(true);
+
+        for (int sheet = 0; sheet < 6; ++sheet)
+        {
+            auto ws = sheet == 0 ? original.active_sheet() : original.create_sheet();
+
+            for (int row = 1; row <= 200; ++row)
+            {
+                ws.cell(1, static_cast<xlnt::row_t>(row)).value(row * (sheet + 1));
+                ws.cell(2, static_cast<xlnt::row_t>(row)).value("text " + std::to_string(row));
+                ws.cell(3, static_cast<xlnt::row_t>(row)).formula("A" + std::to_string(row) + "*2");
+            }
+
+            ws.cell("B2").font(xlnt::font().size(static_cast<double>(sheet + 8)));
+            ws.cell("A1").font(bold);
+
+            if (sheet % 2 == 0)
+            {
+                ws.cell("B3").comment(xlnt::comment("note " + std::to_string(sheet), "author"));
+            }
+        }
+
+        std::vector<std::uint8_t> data;
+        original.save(data);
+
+        xlnt::workbook serial;
+        serial.load(data);
+
+        xlnt::workbook parallel;
+        parallel.thread_count(4);
+        parallel.load(data);
+        xlnt_assert_equals(parallel.thread_count(), 4);
+
+        xlnt_assert_equals(parallel.sheet_titles(), serial.sheet_titles());
+
+        for (std::size_t index = 0; index < serial.sheet_count(); ++index)
+        {
+            auto expected = serial.sheet_by_index(index);
+            auto actual = parallel.sheet_by_index(index);
+
+            xlnt_assert_equals(actual.cell("A200").value<int>(), expected.cell("A200").value<int>());
+            xlnt_assert_equals(actual.cell("B17").value<std::string>(), "text 17");
+            xlnt_assert_equals(actual.cell("C5").formula(), "A5*2");
+            xlnt_assert_equals(actual.cell("B2").font().size(), expected.cell("B2").font().size());
+            xlnt_assert(actual.cell("A1").font().bold());
+            xlnt_assert_equals(actual.cell("B3").has_comment(), (index % 2 == 0));
+
+            if (index % 2 == 0)
+            {
+                xlnt_assert_equals(actual.cell("B3").comment().plain_text(), expected.cell("B3").comment().plain_text());
+            }
+        }
+
+        std::vector<std::uint8_t> serial_data;
+        serial.save(serial_data);
+        std::vector<std::uint8_t> parallel_data;
+        parallel.save(parallel_data);
+
+        xlnt_assert(parallel_data == serial_data);
+    }
+
+    void test_parallel_save()
+    {
+        xlnt::workbook wb;
+        wb.active_sheet().title("Sheet0");
+
+        for (int sheet = 0; sheet < 5; ++sheet)
+        {
+            auto ws = sheet == 0 ? wb.active_sheet() : wb.create_sheet();
+
+            for (int row = 1; row <= 300; ++row)
+            {
+                ws.cell(1, static_cast<xlnt::row_t>(row)).value(row * (sheet + 1));
+                ws.cell(2, static_cast<xlnt::row_t>(row)).value("text " + std::to_string(row % 7));
+                ws.cell(3, static_cast<xlnt::row_t>(row)).value(row / 3.0);
+            }
+
+            ws.cell("A1").font(xlnt::font().bold(true));
+            ws.cell("B4").hyperlink("https://example.com/" + std::to_string(sheet));
+            ws.merge_cells("D1:E2");
+
+            if (sheet % 2 == 1)
+            {
+                ws.cell("B3").comment(xlnt::comment("note " + std::to_string(sheet), "author"));
+            }
+        }
+
+        // a copied sheet is written from its own cells
+        wb.copy_sheet(wb.sheet_by_index(1)).title("Copy");
+
+        std::vector<std::uint8_t> serial_data;
+        wb.save(serial_data);
+
+        for (std::size_t thread_count : {2, 4, 0})
+        {
+            wb.thread_count(thread_count);
+
+            std::vector<std::uint8_t> parallel_data;
+            wb.save(parallel_data);
+
+            xlnt_assert(parallel_data == serial_data);
+        }
+
+        xlnt::workbook loaded;
+        loaded.load(serial_data);
+
+        xlnt_assert_equals(loaded.sheet_count(), 6);
+        xlnt_assert_equals(loaded.sheet_by_title("Copy").cell("A300").value<int>(), 600);
+        xlnt_assert_equals(loaded.sheet_by_title("Copy").cell("B5").value<std::string>(), "text 5");
+        xlnt_assert_equals(loaded.sheet_by_title("Sheet3").cell("B3").comment().plain_text(), "note 3");
+    }
+
+    void test_block_compression()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (int row = 1; row <= 2000; ++row)
+        {
+            ws.cell(1, static_cast<xlnt::row_t>(row)).value(row / 7.0);
+            ws.cell(2, static_cast<xlnt::row_t>(row)).value("text " + std::to_string(row % 13));
+        }
+
+        wb.create_sheet().cell("A1").value("second");
+
+        std::vector<std::uint8_t> single_stream;
+        wb.save(single_stream);
+
+        // blocks smaller than the deflate window must still be primed with all of it
+        wb.compression_block_size(1000);
+        xlnt_assert_equals(wb.compression_block_size(), 1000);
+
+        std::vector<std::uint8_t> serial_data;
+        wb.save(serial_data);
+        xlnt_assert(serial_data != single_stream);
+
+        for (std::size_t thread_count : {3, 0})
+        {
+            wb.thread_count(thread_count);
+
+            std::vector<std::uint8_t> parallel_data;
+            wb.save(parallel_data);
+
+            xlnt_assert(parallel_data == serial_data);
+        }
+
+        xlnt::workbook loaded;
+        loaded.load(serial_data);
+
+        xlnt_assert_equals(loaded.active_sheet().cell("A1400").value<double>(), 200.0);
+        xlnt_assert_equals(loaded.active_sheet().cell("B2000").value<std::string>(), "text 11");
+        xlnt_assert_equals(loaded.sheet_by_index(1).cell("A1").value<std::string>(), "second");
+
+        wb.clear();
+        xlnt_assert_equals(wb.compression_block_size(), 1000);
+    }
 };
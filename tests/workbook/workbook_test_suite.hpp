@@ -56,6 +56,15 @@ public:
         register_test(test_memory);
         register_test(test_clear);
         register_test(test_comparison);
+        register_test(test_shared_string_deduplication);
+        register_test(test_shared_string_storage);
+        register_test(test_copy_is_independent);
+        register_test(test_apply_to_cells);
+        register_test(test_sheet_index);
+        register_test(test_format_deduplication);
+        register_test(test_format_by_index);
+        register_test(test_style_garbage_collection);
+        register_test(test_copied_formats_survive_garbage_collection);
     }
 
     void test_active_sheet()
@@ -327,4 +336,336 @@ public:
         wb.style("style1");
         wb_const.style("style1");
     }
+
+    void test_shared_string_deduplication()
+    {
+        xlnt::workbook wb;
+
+        const auto first = wb.add_shared_string(xlnt::rich_text("a"));
+        const auto second = wb.add_shared_string(xlnt::rich_text("b"));
+        xlnt_assert_equals(first, 0);
+        xlnt_assert_equals(second, 1);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a")), first);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("b")), second);
+        xlnt_assert_equals(wb.shared_string_count(), 2);
+
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a"), true), 2);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a")), first);
+
+        // formatting distinguishes strings with the same text
+        xlnt::font bold;
+        bold.bold(true);
+        const auto rich = wb.add_shared_string(xlnt::rich_text("a", bold));
+        xlnt_assert_equals(rich, 3);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a", bold)), rich);
+        xlnt_assert_equals(wb.shared_string_count(), 4);
+    }
+
+    void test_shared_string_storage()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("plain");
+        xlnt::font bold;
+        bold.bold(true);
+        xlnt::rich_text rich;
+        rich.add_run(xlnt::rich_text_run{"bold", xlnt::optional<xlnt::font>(bold)});
+        rich.add_run(xlnt::rich_text_run{" text", xlnt::optional<xlnt::font>()});
+        ws.cell("A2").value(rich);
+
+        xlnt_assert_equals(ws.cell("A1").text_view().to_string(), "plain");
+        xlnt_assert(ws.cell("A1").text_view() == xlnt::string_view(std::string("plain")));
+        xlnt_assert_equals(ws.cell("A2").text_view().to_string(), "bold text");
+        xlnt_assert_equals(ws.cell("A2").value<xlnt::rich_text>(), rich);
+        xlnt_assert_equals(wb.shared_string(0), xlnt::rich_text("plain"));
+        xlnt_assert_equals(wb.shared_strings().size(), 2);
+        xlnt_assert_throws(wb.shared_string_text(2), xlnt::invalid_parameter);
+
+        ws.cell("A3").value(1);
+        xlnt_assert_throws(ws.cell("A3").text_view(), xlnt::invalid_data_type);
+
+        // the copy stores its own characters
+        xlnt::workbook copy(wb);
+        wb.clear();
+        xlnt_assert_equals(copy.active_sheet().cell("A1").text_view().to_string(), "plain");
+        xlnt_assert_equals(copy.active_sheet().cell("A2").value<xlnt::rich_text>(), rich);
+    }
+
+    void test_copy_is_independent()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(xlnt::cell_reference(1, row)).value(static_cast<int>(row));
+            ws.cell(xlnt::cell_reference(2, row)).value("text " + std::to_string(row));
+        }
+
+        ws.cell("C1").formula("=A1*2");
+
+        xlnt::workbook copy(wb);
+        auto copy_ws = copy.active_sheet();
+
+        // writes to either workbook after the copy stay in that workbook
+        copy_ws.cell("A1").value(-1);
+        copy_ws.cell("B2").value("only in copy");
+        copy_ws.cell("C1").formula("=A1*3");
+        ws.cell("A3").value(-3);
+        ws.cell("B4").value("only in original");
+        ws.cell("D1").value(1);
+
+        xlnt_assert_equals(ws.cell("A1").value<int>(), 1);
+        xlnt_assert_equals(ws.cell("B2").value<std::string>(), "text 2");
+        xlnt_assert_equals(ws.cell("C1").formula(), "A1*2");
+        xlnt_assert_equals(copy_ws.cell("A3").value<int>(), 3);
+        xlnt_assert_equals(copy_ws.cell("B4").value<std::string>(), "text 4");
+        xlnt_assert(!copy_ws.has_cell("D1"));
+
+        xlnt_assert_equals(copy_ws.cell("A1").value<int>(), -1);
+        xlnt_assert_equals(copy_ws.cell("B2").value<std::string>(), "only in copy");
+        xlnt_assert_equals(copy_ws.cell("C1").formula(), "A1*3");
+        xlnt_assert_equals(ws.cell("A3").value<int>(), -3);
+        xlnt_assert_equals(ws.cell("B4").value<std::string>(), "only in original");
+
+        // strings added independently by each workbook land at the same index
+        xlnt_assert_equals(copy.shared_string_text(100).to_string(), "only in copy");
+        xlnt_assert_equals(wb.shared_string_text(100).to_string(), "only in original");
+
+        // cells of a copied sheet belong to the new sheet once written
+        auto sheet_copy = wb.copy_sheet(ws);
+        sheet_copy.cell("A5").value(-5);
+        xlnt_assert_equals(ws.cell("A5").value<int>(), 5);
+        xlnt_assert_equals(sheet_copy.cell("A5").value<int>(), -5);
+        xlnt_assert_equals(sheet_copy.cell("A5").worksheet(), sheet_copy);
+        xlnt_assert_equals(sheet_copy.cell("A6").worksheet(), sheet_copy);
+
+        // handles taken before a copy only ever refer to the cells they were taken from
+        auto handle = ws.cell("A7");
+        xlnt::workbook clone(wb);
+        auto handle_copy = wb.copy_sheet(ws);
+        handle.value(99);
+
+        xlnt_assert_equals(ws.cell("A7").value<int>(), 99);
+        xlnt_assert_equals(clone.active_sheet().cell("A7").value<int>(), 7);
+        xlnt_assert_equals(handle_copy.cell("A7").value<int>(), 7);
+
+        auto copied_handle = handle_copy.cell("A8");
+        copied_handle.value(-8);
+        xlnt_assert_equals(ws.cell("A8").value<int>(), 8);
+    }
+
+    void test_apply_to_cells()
+    {
+        xlnt::workbook wb;
+        auto ws1 = wb.active_sheet();
+        auto ws2 = wb.create_sheet();
+
+        ws1.cell("A1").value(1);
+        ws1.cell("XFD1048576").value(2);
+        ws2.cell("C3").value(3);
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            ws2.cell(xlnt::cell_reference(5, row)).value(static_cast<int>(row));
+        }
+
+        std::vector<std::string> visited;
+        wb.apply_to_cells([&visited](xlnt::cell c) {
+            if (c.row() <= 3 || c.row() == 1048576)
+            {
+                visited.push_back(c.reference().to_string());
+            }
+        });
+
+        const std::vector<std::string> expected{"A1", "XFD1048576", "E1", "E2", "C3", "E3"};
+        xlnt_assert_equals(visited, expected);
+
+        wb.parallel_apply_to_cells([](xlnt::cell c) { c.value(c.value<int>() * 2); }, 4);
+
+        xlnt_assert_equals(ws1.cell("A1").value<int>(), 2);
+        xlnt_assert_equals(ws1.cell("XFD1048576").value<int>(), 4);
+        xlnt_assert_equals(ws2.cell("C3").value<int>(), 6);
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            xlnt_assert_equals(ws2.cell(xlnt::cell_reference(5, row)).value<int>(), static_cast<int>(row) * 2);
+        }
+
+        xlnt_assert_throws(wb.parallel_apply_to_cells([](xlnt::cell c) {
+            if (c.row() == 500) throw xlnt::invalid_parameter();
+        }), xlnt::invalid_parameter);
+    }
+
+    void test_sheet_index()
+    {
+        xlnt::workbook wb;
+
+        for (auto i = 0; i < 2000; ++i)
+        {
+            wb.create_sheet();
+        }
+
+        xlnt_assert_equals(wb.sheet_count(), 2001);
+        xlnt_assert_equals(wb.sheet_by_index(1234).title(), "Sheet1235");
+        xlnt_assert_equals(wb.sheet_by_title("Sheet1235"), wb.sheet_by_index(1234));
+        xlnt_assert_throws(wb.sheet_by_index(2001), xlnt::invalid_parameter);
+
+        auto renamed = wb.sheet_by_index(10);
+        renamed.title("Customer 42");
+        xlnt_assert(!wb.contains("Sheet11"));
+        xlnt_assert_equals(wb.sheet_by_title("Customer 42"), renamed);
+        xlnt_assert_throws(wb.sheet_by_index(11).title("Customer 42"), xlnt::invalid_sheet_title);
+
+        wb.remove_sheet(wb.sheet_by_index(0));
+        xlnt_assert(!wb.contains("Sheet1"));
+        xlnt_assert_equals(wb.sheet_by_index(9), renamed);
+        xlnt_assert_equals(wb.index(renamed), 9);
+
+        auto inserted = wb.create_sheet(0);
+        xlnt_assert_equals(inserted.title(), "Sheet1");
+        xlnt_assert_equals(wb.sheet_by_index(0), inserted);
+        xlnt_assert_equals(wb.sheet_by_index(10), renamed);
+
+        renamed.cell("A1").value("kept");
+        auto copied = wb.copy_sheet(renamed, 1);
+        xlnt_assert_equals(wb.sheet_by_index(1), copied);
+        xlnt_assert_equals(wb.sheet_by_title(copied.title()), copied);
+        xlnt_assert_equals(copied.cell("A1").value<std::string>(), "kept");
+        xlnt_assert_equals(wb.sheet_by_index(11), renamed);
+
+        xlnt::workbook copy(wb);
+        xlnt_assert_equals(copy.sheet_by_title("Customer 42").cell("A1").value<std::string>(), "kept");
+        xlnt_assert_equals(copy.sheet_by_index(11).title(), "Customer 42");
+    }
+
+    void test_format_deduplication()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 500; ++row)
+        {
+            auto cell = ws.cell(xlnt::cell_reference(1, row));
+            cell.font(xlnt::font().size(static_cast<double>(row % 50 + 1)));
+            cell.fill(xlnt::fill::solid(xlnt::rgb_color(static_cast<std::uint8_t>(row % 7), 0, 0)));
+        }
+
+        for (xlnt::row_t row = 1; row <= 500; ++row)
+        {
+            auto cell = ws.cell(xlnt::cell_reference(1, row));
+            xlnt_assert_equals(cell.font().size(), static_cast<double>(row % 50 + 1));
+            xlnt_assert_equals(cell.fill(), xlnt::fill::solid(xlnt::rgb_color(static_cast<std::uint8_t>(row % 7), 0, 0)));
+        }
+
+        // equal styling resolves to one shared format, so changing it in place shows in both cells
+        auto first = ws.cell("A1");
+        auto same = ws.cell(xlnt::cell_reference(1, 351));
+        auto shared = first.format();
+        shared.pivot_button(true);
+        xlnt_assert(same.format().pivot_button());
+
+        // the changed format no longer matches the original styling
+        auto other = ws.cell("B1");
+        other.font(xlnt::font().size(2.));
+        other.fill(xlnt::fill::solid(xlnt::rgb_color(1, 0, 0)));
+        xlnt_assert(!other.format().pivot_button());
+
+        // once changed back it matches again and, being older, is the one that is reused
+        shared.pivot_button(false);
+        auto third = ws.cell("C1");
+        third.font(xlnt::font().size(2.));
+        third.fill(xlnt::fill::solid(xlnt::rgb_color(1, 0, 0)));
+        shared.pivot_button(true);
+        xlnt_assert(third.format().pivot_button());
+        xlnt_assert(!other.format().pivot_button());
+    }
+
+    void test_format_by_index()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 200; ++row)
+        {
+            ws.cell(xlnt::cell_reference(1, row)).font(xlnt::font().size(static_cast<double>(row)));
+        }
+
+        // restyling every other cell erases its old format, compacting the rest
+        for (xlnt::row_t row = 2; row <= 200; row += 2)
+        {
+            ws.cell(xlnt::cell_reference(1, row)).font(xlnt::font().size(1000.));
+        }
+
+        for (xlnt::row_t row = 1; row <= 200; row += 2)
+        {
+            xlnt_assert_equals(ws.cell(xlnt::cell_reference(1, row)).font().size(), static_cast<double>(row));
+        }
+
+        xlnt_assert_equals(ws.cell("A2").font().size(), 1000.);
+
+        auto cell = ws.cell("B1");
+        cell.format(wb.format(0));
+        xlnt_assert(cell.has_format());
+        xlnt_assert_throws(wb.format(1000000), xlnt::invalid_parameter);
+    }
+
+    void test_style_garbage_collection()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto heading = wb.create_style("Heading");
+        heading.font(xlnt::font().size(20.), true);
+        auto highlight = ws.conditional_format(xlnt::range_reference("A1:A10"), xlnt::condition::text_contains("x"));
+        highlight.font(xlnt::font().size(30.));
+
+        // every restyle leaves the previous format and font unused
+        auto cell = ws.cell("A1");
+
+        for (auto size = 1; size <= 1000; ++size)
+        {
+            cell.font(xlnt::font().size(static_cast<double>(size) + 0.5));
+        }
+
+        xlnt_assert_equals(cell.font().size(), 1000.5);
+        xlnt_assert_throws(wb.format(10), xlnt::invalid_parameter);
+
+        // components still referred to by styles and conditional formats survive and follow the compaction
+        xlnt_assert_equals(heading.font().size(), 20.);
+        xlnt_assert_equals(highlight.font().size(), 30.);
+
+        cell.style(heading);
+        cell.clear_format();
+        ws.cell("B1").font(xlnt::font().size(2.));
+        xlnt_assert_equals(heading.font().size(), 20.);
+        xlnt_assert_equals(ws.cell("B1").font().size(), 2.);
+    }
+
+    void test_copied_formats_survive_garbage_collection()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto source = ws.cell("A1");
+        source.value(1);
+        source.font(xlnt::font().size(17.));
+
+        auto copy = ws.cell("B1");
+        copy.value(source);
+        auto sheet_copy = wb.copy_sheet(ws);
+
+        // the source's format is only kept alive by the copies now
+        source.clear_format();
+
+        for (auto size = 1; size <= 20; ++size)
+        {
+            ws.cell(xlnt::cell_reference(4, static_cast<xlnt::row_t>(size))).font(xlnt::font().size(static_cast<double>(size)));
+        }
+
+        xlnt_assert_equals(copy.font().size(), 17.);
+        xlnt_assert_equals(sheet_copy.cell("A1").font().size(), 17.);
+        xlnt_assert_equals(ws.cell("D20").font().size(), 20.);
+    }
 };
@@ -36,6 +36,7 @@ public:
     range_test_suite()
     {
         register_test(test_batch_formatting);
+        register_test(test_batch_formatting_shares_formats);
     }
 
     void test_batch_formatting()
@@ -66,4 +67,30 @@ public:
 
         xlnt_assert(!ws.cell("B2").has_format());
     }
+    void test_batch_formatting_shares_formats()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("B2").font(xlnt::font().size(20.));
+        ws.range("A1:C4").fill(xlnt::fill::solid(xlnt::rgb_color(1, 2, 3)));
+        ws.range("A1:C1").style(wb.create_style("Header"));
+
+        for (auto row : ws.range("A1:C4"))
+        {
+            for (auto cell : row)
+            {
+                xlnt_assert_equals(cell.fill(), xlnt::fill::solid(xlnt::rgb_color(1, 2, 3)));
+                xlnt_assert_equals(cell.font().size(), (cell.reference() == "B2" ? 20. : 12.));
+                xlnt_assert_equals(cell.has_style(), (cell.row() == 1));
+            }
+        }
+
+        // cells that started with equal formats end with one shared format
+        auto shared = ws.cell("A2").format();
+        shared.pivot_button(true);
+        xlnt_assert(ws.cell("C4").format().pivot_button());
+        xlnt_assert(!ws.cell("B2").format().pivot_button());
+        xlnt_assert(!ws.cell("A1").format().pivot_button());
+    }
 };
@@ -23,7 +23,9 @@
 
 #pragma once
 
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 #include <helpers/test_suite.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -93,6 +95,13 @@ public:
         register_test(test_get_point_pos);
         register_test(test_named_range_named_cell_reference);
         register_test(test_iteration_skip_empty);
+        register_test(test_cell_handles_stable);
+        register_test(test_arena_statistics);
+        register_test(test_arena_reuse);
+        register_test(test_bounds_after_garbage_collect);
+        register_test(test_sparse_iteration);
+        register_test(test_bulk_write);
+        register_test(test_bulk_read);
     }
 
     void test_new_worksheet()
@@ -1088,4 +1097,243 @@ public:
             xlnt_assert_equals(cells[1].value<std::string>(), "F6");
         }
     }
+
+    void test_cell_handles_stable()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto cell = ws.cell("C500");
+        cell.value(42);
+
+        // insert rows before it and cells to its left in the same row
+        for (xlnt::row_t row = 1; row <= 200; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 20; ++column)
+            {
+                ws.cell(xlnt::cell_reference(column, row)).value(static_cast<int>(row));
+            }
+        }
+
+        ws.cell("B500").value(1);
+        ws.cell("A500");
+
+        xlnt_assert(ws.cell("C500") == cell);
+        xlnt_assert_equals(cell.reference(), "C500");
+        xlnt_assert_equals(cell.value<int>(), 42);
+
+        ws.garbage_collect();
+
+        xlnt_assert(!ws.has_cell("A500"));
+        xlnt_assert(ws.cell("C500") == cell);
+        xlnt_assert_equals(cell.value<int>(), 42);
+        xlnt_assert_equals(ws.cell("T200").value<int>(), 200);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:T500"));
+    }
+
+    void test_arena_statistics()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto empty = ws.arena_statistics();
+
+        for (auto row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, static_cast<xlnt::row_t>(row)).value(row);
+        }
+
+        ws.cell("B1").formula("=SUM(A1:A100)");
+        ws.cell("B2").hyperlink("http://example.com");
+
+        const auto filled = ws.arena_statistics();
+        xlnt_assert(filled.allocations > empty.allocations + 100);
+        xlnt_assert(filled.bytes_allocated > empty.bytes_allocated);
+        xlnt_assert(filled.bytes_reserved >= filled.bytes_allocated);
+        xlnt_assert(filled.chunks > 0);
+
+        auto copy = wb.copy_sheet(ws);
+        wb.remove_sheet(ws);
+
+        xlnt_assert_equals(copy.cell("B1").formula(), "SUM(A1:A100)");
+        xlnt_assert_equals(copy.cell("B2").hyperlink(), "http://example.com");
+        xlnt_assert_equals(copy.cell("A100").value<int>(), 100);
+        xlnt_assert_equals(wb.arena_statistics().bytes_allocated, copy.arena_statistics().bytes_allocated);
+    }
+
+    void test_arena_reuse()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto edit = [&ws](int round) {
+            for (auto row = 1; row <= 200; ++row)
+            {
+                auto cell = ws.cell(1, static_cast<xlnt::row_t>(row));
+                cell.formula("=SUM(B1:B" + std::to_string(row + round % 7) + ")");
+                cell.hyperlink("http://example.com/" + std::to_string(round % 5));
+            }
+
+            for (auto row = 1; row <= 200; row += 2)
+            {
+                ws.cell(1, static_cast<xlnt::row_t>(row)).clear_formula();
+            }
+        };
+
+        edit(0);
+        const auto settled = ws.arena_statistics();
+
+        for (auto round = 1; round < 50; ++round)
+        {
+            edit(round);
+        }
+
+        xlnt_assert_equals(ws.arena_statistics().bytes_reserved, settled.bytes_reserved);
+        xlnt_assert_equals(ws.cell("A2").formula(), "SUM(B1:B2)");
+        xlnt_assert_equals(ws.cell("A2").hyperlink(), "http://example.com/4");
+        xlnt_assert(!ws.cell("A1").has_formula());
+    }
+
+    void test_bounds_after_garbage_collect()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("C3").value(1);
+        ws.cell("E4").value(2);
+        ws.cell("A1");
+        ws.cell("Z100");
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:Z100"));
+
+        ws.garbage_collect();
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("C3:E4"));
+        xlnt_assert_equals(ws.lowest_column(), "C");
+        xlnt_assert_equals(ws.highest_row(), 4);
+
+        ws.cell("B10").value(3);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B3:E10"));
+    }
+
+    void test_sparse_iteration()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value(1);
+        ws.cell("C5000").value(2);
+        ws.cell("XFD1048576").value(3);
+
+        std::vector<std::string> visited;
+
+        for (auto row : ws.rows())
+        {
+            for (auto cell : row)
+            {
+                visited.push_back(cell.reference().to_string());
+            }
+        }
+
+        xlnt_assert_equals(visited, std::vector<std::string>({"A1", "C5000", "XFD1048576"}));
+
+        visited.clear();
+
+        for (auto cell : ws.cells())
+        {
+            visited.push_back(cell.reference().to_string());
+        }
+
+        xlnt_assert_equals(visited, std::vector<std::string>({"A1", "C5000", "XFD1048576"}));
+
+        visited.clear();
+
+        for (auto column : ws.columns())
+        {
+            visited.push_back(column.front().reference().to_string());
+        }
+
+        xlnt_assert_equals(visited, std::vector<std::string>({"A1", "C5000", "XFD1048576"}));
+
+        auto cells = ws.cells();
+        auto last = cells.end();
+        xlnt_assert_equals((*--last).reference(), "XFD1048576");
+        xlnt_assert_equals((*--last).reference(), "C5000");
+        xlnt_assert_equals((*--last).reference(), "A1");
+        xlnt_assert(last == cells.begin());
+
+        xlnt_assert(!ws.has_cell("B1"));
+        xlnt_assert_equals(ws.rows(false).length(), 1048576);
+    }
+
+    void test_bulk_write()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.write_row(1, std::vector<double>{1.5, 2.5, 3.5});
+        xlnt_assert_equals(ws.cell("A1").value<double>(), 1.5);
+        xlnt_assert_equals(ws.cell("C1").value<double>(), 3.5);
+
+        ws.write_row(2, std::vector<std::string>{"a", "b"}, 2);
+        xlnt_assert(!ws.has_cell("A2"));
+        xlnt_assert_equals(ws.cell("B2").value<std::string>(), "a");
+        xlnt_assert_equals(ws.cell("C2").data_type(), xlnt::cell::type::shared_string);
+
+        ws.write_row(3, std::make_tuple(7, std::string("text"), 0.25, true));
+        xlnt_assert_equals(ws.cell("A3").value<int>(), 7);
+        xlnt_assert_equals(ws.cell("B3").value<std::string>(), "text");
+        xlnt_assert_equals(ws.cell("C3").value<double>(), 0.25);
+        xlnt_assert_equals(ws.cell("D3").data_type(), xlnt::cell::type::boolean);
+
+        // column-major: first column is 1, 2, 3 and second column is 4, 5, 6
+        const double block[] = {1, 2, 3, 4, 5, 6};
+        ws.write_block("E10", block, 3, 2);
+        xlnt_assert_equals(ws.cell("E10").value<int>(), 1);
+        xlnt_assert_equals(ws.cell("E12").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("F10").value<int>(), 4);
+        xlnt_assert_equals(ws.cell("F12").value<int>(), 6);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:F12"));
+
+        const auto last_column = xlnt::column_t(std::numeric_limits<xlnt::column_t::index_t>::max());
+        xlnt_assert_throws(ws.write_row(4, std::vector<double>{1, 2}, last_column), xlnt::invalid_parameter);
+
+        xlnt_assert_throws(ws.cell(xlnt::column_t(1), 0), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(ws.cell(xlnt::column_t(0u), 1), xlnt::invalid_cell_reference);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:F12"));
+    }
+
+    void test_bulk_read()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("B2").value(1.5);
+        ws.cell("B3").value("text");
+        ws.cell("B4").value(true);
+        ws.cell("B6").error("#N/A");
+        ws.cell("B7");
+
+        const auto numbers = ws.read_numbers("B", 1, 7);
+        xlnt_assert_equals(numbers.size(), 7);
+        xlnt_assert(std::isnan(numbers[0]));
+        xlnt_assert_equals(numbers[1], 1.5);
+        xlnt_assert(std::isnan(numbers[2]));
+        xlnt_assert_equals(numbers[3], 1.0);
+
+        const auto strings = ws.read_strings("B", 2, 6);
+        xlnt_assert_equals(strings, std::vector<std::string>({"", "text", "", "", "#N/A"}));
+
+        const auto column = ws.read_column("B", 2, 7);
+        xlnt_assert_equals(column.first_row, 2);
+        xlnt_assert_equals(column.types[1], xlnt::cell_type::shared_string);
+        xlnt_assert_equals(column.types[4], xlnt::cell_type::error);
+        xlnt_assert_equals(column.valid, std::vector<bool>({true, true, true, false, true, false}));
+        xlnt_assert_equals(column.numbers[0], 1.5);
+        xlnt_assert_equals(column.strings[1], "text");
+
+        xlnt_assert(ws.read_numbers("B", 5, 4).empty());
+
+        const auto last_row = std::numeric_limits<xlnt::row_t>::max();
+        xlnt_assert_throws(ws.read_numbers("B", 0, last_row), xlnt::invalid_parameter);
+        xlnt_assert_throws(ws.read_strings("B", 0, 3), xlnt::invalid_parameter);
+        xlnt_assert_throws(ws.read_column("B", 2, 0), xlnt::invalid_parameter);
+    }
 };